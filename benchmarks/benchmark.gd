@@ -0,0 +1,32 @@
+extends Node2D
+
+# Runs FlashBenchmark and SpineBenchmark on the fixtures and prints their
+# results as JSON. Settings can be overridden after `--`, e.g.
+#   godot --headless --path benchmarks -- --players=200 --frames=600
+# Headless runs quit once done, windowed ones keep showing the fixtures.
+
+const FLASH_DOCUMENT = "res://fixtures/flash/sample.zip"
+const SPINE_DATA = "res://fixtures/spine/sample_data.tres"
+
+
+func _ready() -> void:
+	$SpineSprite.get_animation_state().set_animation("wave", true, 0)
+
+	var args := {}
+	for arg in OS.get_cmdline_user_args():
+		var parts: PackedStringArray = arg.trim_prefix("--").split("=", true, 1)
+		args[parts[0]] = parts[1] if parts.size() > 1 else ""
+
+	var flash := FlashBenchmark.new()
+	flash.players = int(args.get("players", flash.players))
+	flash.frames = int(args.get("frames", flash.frames))
+	flash.use_threads = args.get("threads", "true") != "false"
+	print(flash.run_json(args.get("flash", FLASH_DOCUMENT)))
+
+	var spine := SpineBenchmark.new()
+	spine.sprites = int(args.get("players", spine.sprites))
+	spine.frames = int(args.get("frames", spine.frames))
+	print(spine.run_json(args.get("spine", SPINE_DATA)))
+
+	if DisplayServer.get_name() == "headless":
+		get_tree().quit()
@@ -0,0 +1,165 @@
+// MIT License
+
+// Copyright (c) 2021 Yakov Borevich, Funexpected LLC
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "flash_benchmark.h"
+#include "flash_player.h"
+#include "flash_resources.h"
+
+#include <core/config/engine.h>
+#include <core/io/json.h>
+#include <core/io/resource_loader.h>
+#include <core/object/worker_thread_pool.h>
+#include <core/os/os.h>
+
+void FlashBenchmark::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("run", "path"), &FlashBenchmark::run);
+    ClassDB::bind_method(D_METHOD("run_json", "path"), &FlashBenchmark::run_json);
+    ClassDB::bind_method(D_METHOD("set_players", "players"), &FlashBenchmark::set_players);
+    ClassDB::bind_method(D_METHOD("get_players"), &FlashBenchmark::get_players);
+    ClassDB::bind_method(D_METHOD("set_frames", "frames"), &FlashBenchmark::set_frames);
+    ClassDB::bind_method(D_METHOD("get_frames"), &FlashBenchmark::get_frames);
+    ClassDB::bind_method(D_METHOD("set_delta", "delta"), &FlashBenchmark::set_delta);
+    ClassDB::bind_method(D_METHOD("get_delta"), &FlashBenchmark::get_delta);
+    ClassDB::bind_method(D_METHOD("set_symbol", "symbol"), &FlashBenchmark::set_symbol);
+    ClassDB::bind_method(D_METHOD("get_symbol"), &FlashBenchmark::get_symbol);
+    ClassDB::bind_method(D_METHOD("set_clip", "clip"), &FlashBenchmark::set_clip);
+    ClassDB::bind_method(D_METHOD("get_clip"), &FlashBenchmark::get_clip);
+    ClassDB::bind_method(D_METHOD("set_use_threads", "use_threads"), &FlashBenchmark::set_use_threads);
+    ClassDB::bind_method(D_METHOD("is_using_threads"), &FlashBenchmark::is_using_threads);
+
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "players"), "set_players", "get_players");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "frames"), "set_frames", "get_frames");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "delta"), "set_delta", "get_delta");
+    ADD_PROPERTY(PropertyInfo(Variant::STRING, "symbol"), "set_symbol", "get_symbol");
+    ADD_PROPERTY(PropertyInfo(Variant::STRING, "clip"), "set_clip", "get_clip");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "use_threads"), "set_use_threads", "is_using_threads");
+}
+
+void FlashBenchmark::_evaluate_player(uint32_t p_index, FlashPlayer **p_players) {
+    p_players[p_index]->_animation_evaluate();
+}
+
+Dictionary FlashBenchmark::run(const String &p_path) {
+    Dictionary result;
+    OS *os = OS::get_singleton();
+
+    uint64_t start = os->get_ticks_usec();
+    Ref<FlashDocument> doc = ResourceLoader::load(p_path, "", ResourceFormatLoader::CACHE_MODE_IGNORE);
+    uint64_t load_usec = os->get_ticks_usec() - start;
+    ERR_FAIL_COND_V_MSG(doc.is_null(), result, "Can't load flash document: " + p_path);
+
+    start = os->get_ticks_usec();
+    LocalVector<FlashPlayer*> instances;
+    for (int i=0; i<players; i++) {
+        FlashPlayer *player = memnew(FlashPlayer);
+        player->set_resource(doc);
+        if (symbol != String()) player->set_active_symbol(symbol);
+        if (clip != String()) player->set_active_clip(clip);
+        player->set_loop(true);
+        player->set_playing(true);
+        // spread players over the timeline, so they don't evaluate identical frames
+        player->advance(delta * i * 7, false, true);
+        instances.push_back(player);
+    }
+    uint64_t setup_usec = os->get_ticks_usec() - start;
+
+    uint64_t process_usec = 0;
+    uint64_t mesh_usec = 0;
+    uint64_t clipping_usec = 0;
+    uint64_t triangles = 0;
+    uint64_t vertices = 0;
+    for (int f=0; f<frames; f++) {
+        for (uint32_t i=0; i<instances.size(); i++) {
+            instances[i]->advance(delta, false, true);
+        }
+
+        start = os->get_ticks_usec();
+        batch.clear();
+        for (uint32_t i=0; i<instances.size(); i++) {
+            if (instances[i]->_animation_begin()) batch.push_back(instances[i]);
+        }
+        if (use_threads && batch.size() > 1) {
+            WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_template_group_task(
+                this, &FlashBenchmark::_evaluate_player, batch.ptr(), batch.size(), -1, true, SNAME("FlashBenchmark")
+            );
+            WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+        } else {
+            for (uint32_t i=0; i<batch.size(); i++) {
+                _evaluate_player(i, batch.ptr());
+            }
+        }
+        for (uint32_t i=0; i<batch.size(); i++) {
+            batch[i]->_animation_end();
+        }
+        process_usec += os->get_ticks_usec() - start;
+
+        // same work NOTIFICATION_DRAW does, without submitting canvas items
+        for (uint32_t i=0; i<batch.size(); i++) {
+            FlashPlayer *player = batch[i];
+            if (player->vertex_count == 0) continue;
+            start = os->get_ticks_usec();
+            player->update_clipping_data();
+            uint64_t clipped = os->get_ticks_usec();
+            player->update_mesh();
+            clipping_usec += clipped - start;
+            mesh_usec += os->get_ticks_usec() - clipped;
+            triangles += player->index_count / 3;
+            vertices += player->vertex_count;
+        }
+    }
+    batch.clear();
+
+    for (uint32_t i=0; i<instances.size(); i++) {
+        memdelete(instances[i]);
+    }
+
+    Dictionary stages;
+    stages["load_ms"] = load_usec / 1000.0;
+    stages["setup_ms"] = setup_usec / 1000.0;
+    stages["animation_process_ms"] = process_usec / 1000.0;
+    stages["mesh_build_ms"] = mesh_usec / 1000.0;
+    stages["clipping_ms"] = clipping_usec / 1000.0;
+
+    result["runtime"] = "flash";
+    result["engine_version"] = Engine::get_singleton()->get_version_info()["string"];
+    result["path"] = p_path;
+    result["symbol"] = symbol != String() ? symbol : String("[document]");
+    result["players"] = players;
+    result["frames"] = frames;
+    result["threads"] = use_threads;
+    result["stages"] = stages;
+    result["frame_ms"] = (process_usec + mesh_usec + clipping_usec) / 1000.0 / frames;
+    result["triangles_per_frame"] = (double)triangles / frames;
+    result["vertices_per_frame"] = (double)vertices / frames;
+    return result;
+}
+
+String FlashBenchmark::run_json(const String &p_path) {
+    return JSON::stringify(run(p_path), "\t", false);
+}
+
+FlashBenchmark::FlashBenchmark() {
+    players = 100;
+    frames = 300;
+    delta = 1.0 / 60.0;
+    use_threads = false;
+}
@@ -0,0 +1,72 @@
+// MIT License
+
+// Copyright (c) 2021 Yakov Borevich, Funexpected LLC
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FLASH_BENCHMARK_H
+#define FLASH_BENCHMARK_H
+
+#include <core/object/ref_counted.h>
+#include <core/templates/local_vector.h>
+#include <core/variant/dictionary.h>
+
+class FlashPlayer;
+
+// Steps a number of players for a number of frames outside of the scene tree
+// and reports time spent per stage. Meant to be run headless (the dummy
+// rendering server still takes mesh and texture uploads), `benchmarks/`
+// runs it on a sample document with `FlashBenchmark.new().run_json(path)`.
+class FlashBenchmark: public RefCounted {
+    GDCLASS(FlashBenchmark, RefCounted);
+
+    int players;
+    int frames;
+    float delta;
+    String symbol;
+    String clip;
+    bool use_threads;
+
+    LocalVector<FlashPlayer*> batch;
+    void _evaluate_player(uint32_t p_index, FlashPlayer **p_players);
+
+protected:
+    static void _bind_methods();
+
+public:
+    int get_players() const { return players; }
+    void set_players(int p_players) { players = MAX(p_players, 1); }
+    int get_frames() const { return frames; }
+    void set_frames(int p_frames) { frames = MAX(p_frames, 1); }
+    float get_delta() const { return delta; }
+    void set_delta(float p_delta) { delta = p_delta; }
+    String get_symbol() const { return symbol; }
+    void set_symbol(const String &p_symbol) { symbol = p_symbol; }
+    String get_clip() const { return clip; }
+    void set_clip(const String &p_clip) { clip = p_clip; }
+    bool is_using_threads() const { return use_threads; }
+    void set_use_threads(bool p_use_threads) { use_threads = p_use_threads; }
+
+    Dictionary run(const String &p_path);
+    String run_json(const String &p_path);
+
+    FlashBenchmark();
+};
+
+#endif
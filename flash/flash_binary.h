@@ -0,0 +1,167 @@
+// MIT License
+
+// Copyright (c) 2021 Yakov Borevich, Funexpected LLC
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FLASH_BINARY_H
+#define FLASH_BINARY_H
+
+#include <stdint.h>
+
+// Binary FlashDocument layout written by the importer (`.flashdoc`).
+//
+// The file is a header followed by flat, 4-byte aligned sections of
+// fixed size records, so it can be read with a single call and used
+// in place. Records reference each other by index into other sections,
+// strings are indices into the string table (0 is always "").
+// Every timeline owns a contiguous range of layers, every layer a
+// contiguous range of frames and every frame a contiguous range of
+// element refs and tweens. Values are stored in native (little endian) order.
+
+#define FLASH_BINARY_MAGIC "GDFL"
+#define FLASH_BINARY_VERSION 3
+// groups are walked recursively, deeper nesting is rejected on load
+#define FLASH_BINARY_MAX_GROUP_DEPTH 32
+
+enum FlashBinarySection {
+    FLASH_BINARY_SECTION_STRINGS,
+    FLASH_BINARY_SECTION_STRING_DATA,
+    FLASH_BINARY_SECTION_BITMAPS,
+    FLASH_BINARY_SECTION_TIMELINES,
+    FLASH_BINARY_SECTION_LAYERS,
+    FLASH_BINARY_SECTION_FRAMES,
+    FLASH_BINARY_SECTION_ELEMENTS,
+    FLASH_BINARY_SECTION_ELEMENT_REFS,
+    FLASH_BINARY_SECTION_TWEENS,
+    FLASH_BINARY_SECTION_TWEEN_POINTS,
+    FLASH_BINARY_SECTION_POLYGON_POINTS,
+    FLASH_BINARY_SECTION_MAX
+};
+
+enum FlashBinaryElementKind {
+    FLASH_BINARY_ELEMENT_SHAPE,
+    FLASH_BINARY_ELEMENT_INSTANCE,
+    FLASH_BINARY_ELEMENT_GROUP,
+    FLASH_BINARY_ELEMENT_BITMAP
+};
+
+struct FlashBinarySectionInfo {
+    uint32_t offset;
+    uint32_t count;
+};
+
+struct FlashBinaryHeader {
+    char magic[4];
+    uint32_t version;
+    int32_t last_eid;
+    float frame_size;
+    int32_t atlas_path;
+    int32_t flags;
+    FlashBinarySectionInfo sections[FLASH_BINARY_SECTION_MAX];
+};
+
+enum FlashBinaryHeaderFlags {
+    FLASH_BINARY_FLAG_BAKE_FRAMES = 1,
+    FLASH_BINARY_FLAG_BAKE_INTERPOLATION = 2,
+    // symbol content is read on first use, the file stays in memory
+    FLASH_BINARY_FLAG_LAZY_SYMBOLS = 4
+};
+
+struct FlashBinaryBitmap {
+    int32_t eid;
+    int32_t name;
+    int32_t bitmap_path;
+    int32_t has_texture;
+    int32_t texture_index;
+    float region[4];
+    float margin[4];
+    float original_size[2];
+    int32_t rotated;
+    int32_t first_polygon_point;
+    int32_t polygon_point_count;
+};
+
+struct FlashBinaryTimeline {
+    int32_t eid;
+    int32_t is_symbol;
+    int32_t token;
+    int32_t local_path;
+    int32_t duration;
+    int32_t first_layer;
+    int32_t layer_count;
+};
+
+// layers are stored in parse order, masks and regular layers interleaved
+struct FlashBinaryLayer {
+    int32_t eid;
+    int32_t layer_name;
+    int32_t type;
+    int32_t index;
+    int32_t duration;
+    int32_t mask_id;
+    float color[4];
+    int32_t first_frame;
+    int32_t frame_count;
+};
+
+struct FlashBinaryFrame {
+    int32_t eid;
+    int32_t index;
+    int32_t duration;
+    int32_t frame_name;
+    int32_t label_type;
+    int32_t keymode;
+    int32_t tween_type;
+    float color_add[4];
+    float color_mult[4];
+    int32_t first_element_ref;
+    int32_t element_count;
+    int32_t first_tween;
+    int32_t tween_count;
+};
+
+// `name` is the symbol token for instances and the library item for bitmaps,
+// groups keep their members in the element refs section, members are always
+// written after their group so they have greater indices
+struct FlashBinaryElement {
+    int32_t eid;
+    int32_t kind;
+    float transform[6];
+    int32_t name;
+    int32_t loop;
+    int32_t first_frame;
+    float color_add[4];
+    float color_mult[4];
+    float center_point[2];
+    float transformation_point[2];
+    int32_t first_member_ref;
+    int32_t member_count;
+};
+
+struct FlashBinaryTween {
+    int32_t eid;
+    int32_t target;
+    int32_t method;
+    float intensity;
+    int32_t first_point;
+    int32_t point_count;
+};
+
+#endif
@@ -0,0 +1,245 @@
+// MIT License
+
+// Copyright (c) 2021 Yakov Borevich, Funexpected LLC
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "flash_multi_player.h"
+
+static inline float _modulate_channel(float p_value, float p_modulate) {
+    // vertex colors keep the add part in the integer and mult * 0.5 in the fraction
+    float add = Math::floor(p_value);
+    return MIN((p_value - add) * p_modulate, 0.9999f) + add;
+}
+
+static inline Color _modulate_color(const Color &p_color, const Color &p_modulate) {
+    return Color(
+        _modulate_channel(p_color.r, p_modulate.r),
+        _modulate_channel(p_color.g, p_modulate.g),
+        _modulate_channel(p_color.b, p_modulate.b),
+        _modulate_channel(p_color.a, p_modulate.a)
+    );
+}
+
+void FlashMultiPlayer::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("set_instance_count", "count"), &FlashMultiPlayer::set_instance_count);
+    ClassDB::bind_method(D_METHOD("get_instance_count"), &FlashMultiPlayer::get_instance_count);
+    ClassDB::bind_method(D_METHOD("set_instance_transform", "instance", "transform"), &FlashMultiPlayer::set_instance_transform);
+    ClassDB::bind_method(D_METHOD("get_instance_transform", "instance"), &FlashMultiPlayer::get_instance_transform);
+    ClassDB::bind_method(D_METHOD("set_instance_frame_offset", "instance", "frame_offset"), &FlashMultiPlayer::set_instance_frame_offset);
+    ClassDB::bind_method(D_METHOD("get_instance_frame_offset", "instance"), &FlashMultiPlayer::get_instance_frame_offset);
+    ClassDB::bind_method(D_METHOD("set_instance_color", "instance", "color"), &FlashMultiPlayer::set_instance_color);
+    ClassDB::bind_method(D_METHOD("get_instance_color", "instance"), &FlashMultiPlayer::get_instance_color);
+    ClassDB::bind_method(D_METHOD("set_instance_transforms", "transforms"), &FlashMultiPlayer::set_instance_transforms);
+    ClassDB::bind_method(D_METHOD("get_instance_transforms"), &FlashMultiPlayer::get_instance_transforms);
+    ClassDB::bind_method(D_METHOD("set_instance_frame_offsets", "frame_offsets"), &FlashMultiPlayer::set_instance_frame_offsets);
+    ClassDB::bind_method(D_METHOD("get_instance_frame_offsets"), &FlashMultiPlayer::get_instance_frame_offsets);
+    ClassDB::bind_method(D_METHOD("set_instance_colors", "colors"), &FlashMultiPlayer::set_instance_colors);
+    ClassDB::bind_method(D_METHOD("get_instance_colors"), &FlashMultiPlayer::get_instance_colors);
+
+    // transforms go first, they define the instance count when loaded
+    ADD_PROPERTY(PropertyInfo(Variant::ARRAY, "instance_transforms", PROPERTY_HINT_ARRAY_TYPE, "Transform2D"), "set_instance_transforms", "get_instance_transforms");
+    ADD_PROPERTY(PropertyInfo(Variant::PACKED_FLOAT32_ARRAY, "instance_frame_offsets"), "set_instance_frame_offsets", "get_instance_frame_offsets");
+    ADD_PROPERTY(PropertyInfo(Variant::PACKED_COLOR_ARRAY, "instance_colors"), "set_instance_colors", "get_instance_colors");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "instance_count", PROPERTY_HINT_RANGE, "0,65535,1", PROPERTY_USAGE_EDITOR), "set_instance_count", "get_instance_count");
+}
+
+void FlashMultiPlayer::instances_changed() {
+    tracks_dirty = true;
+    queue_process();
+}
+
+void FlashMultiPlayer::set_instance_count(int p_count) {
+    ERR_FAIL_COND(p_count < 0);
+    int count = instance_transforms.size();
+    if (count == p_count) return;
+    instance_transforms.resize(p_count);
+    instance_frame_offsets.resize(p_count);
+    instance_colors.resize(p_count);
+    for (int i=count; i<p_count; i++) {
+        instance_transforms.set(i, Transform2D());
+        instance_frame_offsets.set(i, 0.0);
+        instance_colors.set(i, Color(1, 1, 1, 1));
+    }
+    instances_changed();
+}
+
+Transform2D FlashMultiPlayer::get_instance_transform(int p_instance) const {
+    ERR_FAIL_INDEX_V(p_instance, instance_transforms.size(), Transform2D());
+    return instance_transforms[p_instance];
+}
+
+void FlashMultiPlayer::set_instance_transform(int p_instance, const Transform2D &p_transform) {
+    ERR_FAIL_INDEX(p_instance, instance_transforms.size());
+    instance_transforms.set(p_instance, p_transform);
+    instances_changed();
+}
+
+float FlashMultiPlayer::get_instance_frame_offset(int p_instance) const {
+    ERR_FAIL_INDEX_V(p_instance, instance_frame_offsets.size(), 0.0);
+    return instance_frame_offsets[p_instance];
+}
+
+void FlashMultiPlayer::set_instance_frame_offset(int p_instance, float p_frame_offset) {
+    ERR_FAIL_INDEX(p_instance, instance_frame_offsets.size());
+    instance_frame_offsets.set(p_instance, p_frame_offset);
+    instances_changed();
+}
+
+Color FlashMultiPlayer::get_instance_color(int p_instance) const {
+    ERR_FAIL_INDEX_V(p_instance, instance_colors.size(), Color());
+    return instance_colors[p_instance];
+}
+
+void FlashMultiPlayer::set_instance_color(int p_instance, const Color &p_color) {
+    ERR_FAIL_INDEX(p_instance, instance_colors.size());
+    instance_colors.set(p_instance, p_color);
+    instances_changed();
+}
+
+Array FlashMultiPlayer::get_instance_transforms() const {
+    Array result;
+    result.resize(instance_transforms.size());
+    for (int i=0; i<instance_transforms.size(); i++) {
+        result[i] = instance_transforms[i];
+    }
+    return result;
+}
+
+void FlashMultiPlayer::set_instance_transforms(const Array &p_transforms) {
+    set_instance_count(p_transforms.size());
+    for (int i=0; i<p_transforms.size(); i++) {
+        instance_transforms.set(i, p_transforms[i]);
+    }
+    instances_changed();
+}
+
+PackedFloat32Array FlashMultiPlayer::get_instance_frame_offsets() const {
+    return instance_frame_offsets;
+}
+
+void FlashMultiPlayer::set_instance_frame_offsets(const PackedFloat32Array &p_frame_offsets) {
+    for (int i=0; i<instance_frame_offsets.size(); i++) {
+        instance_frame_offsets.set(i, i < p_frame_offsets.size() ? p_frame_offsets[i] : 0.0);
+    }
+    instances_changed();
+}
+
+PackedColorArray FlashMultiPlayer::get_instance_colors() const {
+    return instance_colors;
+}
+
+void FlashMultiPlayer::set_instance_colors(const PackedColorArray &p_colors) {
+    for (int i=0; i<instance_colors.size(); i++) {
+        instance_colors.set(i, i < p_colors.size() ? p_colors[i] : Color(1, 1, 1, 1));
+    }
+    instances_changed();
+}
+
+int FlashMultiPlayer::get_instance_frame(int p_instance, int p_duration) const {
+    int start = CLAMP((int)Math::floor(playback_start), 0, p_duration - 1);
+    int end = CLAMP((int)Math::ceil(playback_end), start + 1, p_duration);
+    int instance_frame = (int)Math::floor(frame + instance_frame_offsets[p_instance]);
+    if (loop) {
+        return start + (int)Math::posmod((int64_t)(instance_frame - start), (int64_t)(end - start));
+    }
+    return CLAMP(instance_frame, start, end - 1);
+}
+
+bool FlashMultiPlayer::get_local_bounds(Rect2 &r_bounds) {
+    Rect2 symbol_bounds;
+    if (!FlashPlayer::get_local_bounds(symbol_bounds)) return false;
+    bool has_bounds = false;
+    for (int i=0; i<instance_transforms.size(); i++) {
+        Rect2 instance_bounds = instance_transforms[i].xform(symbol_bounds);
+        r_bounds = has_bounds ? r_bounds.merge(instance_bounds) : instance_bounds;
+        has_bounds = true;
+    }
+    return has_bounds;
+}
+
+void FlashMultiPlayer::_animation_evaluate() {
+    // may run on a worker thread, same as the base evaluation
+    int duration = MAX(active_symbol->get_duration(), 1);
+    int count = instance_transforms.size();
+    frame_slots.clear();
+    snapshots.clear();
+    instance_slots.resize(count);
+
+    int total_vertices = 0;
+    int total_indices = 0;
+    for (int i=0; i<count; i++) {
+        int instance_frame = get_instance_frame(i, duration);
+        const int *slot = frame_slots.getptr(instance_frame);
+        if (slot == nullptr) {
+            frame_slots[instance_frame] = snapshots.size();
+            snapshots.push_back(use_baked_frames ? get_baked_frame(instance_frame) : evaluate_frame(instance_frame));
+            slot = frame_slots.getptr(instance_frame);
+        }
+        instance_slots[i] = *slot;
+        total_vertices += snapshots[*slot].points.size();
+        total_indices += snapshots[*slot].indices.size();
+    }
+
+    masks.clear();
+    clipping_cache.clear();
+    clipping_items.clear();
+    clear_geometry();
+    reserve_geometry(total_vertices, total_indices);
+    Vector2 *w_points = points.ptrw();
+    Vector2 *w_uvs = uvs.ptrw();
+    Color *w_colors = colors.ptrw();
+    int *w_indices = indices.ptrw();
+
+    for (int i=0; i<count; i++) {
+        const FlashBakedFrame &snapshot = snapshots[instance_slots[i]];
+        const Transform2D &tr = instance_transforms[i];
+        const Color &modulate = instance_colors[i];
+
+        // clipping rows are stored in node space, every instance gets its own copy
+        Vector2 clipping_offset;
+        if (snapshot.clipping.size() > 0) {
+            clipping_offset.x = clipping_cache.size();
+            for (int c=0; c<snapshot.clipping.size(); c++) {
+                FlashMaskItem item = snapshot.clipping[c];
+                item.transform = tr * item.transform;
+                clipping_cache.push_back(item);
+            }
+        }
+
+        int snapshot_vertices = snapshot.points.size();
+        const Vector2 *r_points = snapshot.points.ptr();
+        const Vector2 *r_uvs = snapshot.uvs.ptr();
+        const Color *r_colors = snapshot.colors.ptr();
+        bool modulated = modulate != Color(1, 1, 1, 1);
+        for (int v=0; v<snapshot_vertices; v++) {
+            w_points[vertex_count + v] = tr.xform(r_points[v]);
+            w_uvs[vertex_count + v] = r_uvs[v] + clipping_offset;
+            w_colors[vertex_count + v] = modulated ? _modulate_color(r_colors[v], modulate) : r_colors[v];
+        }
+        int snapshot_indices = snapshot.indices.size();
+        const int *r_indices = snapshot.indices.ptr();
+        for (int k=0; k<snapshot_indices; k++) {
+            w_indices[index_count + k] = r_indices[k] + vertex_count;
+        }
+        vertex_count += snapshot_vertices;
+        index_count += snapshot_indices;
+    }
+    snapshots.clear();
+}
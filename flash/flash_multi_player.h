@@ -0,0 +1,72 @@
+// MIT License
+
+// Copyright (c) 2021 Yakov Borevich, Funexpected LLC
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FLASH_MULTI_PLAYER_H
+#define FLASH_MULTI_PLAYER_H
+
+#include "flash_player.h"
+
+// Draws many copies of the active symbol within a single mesh.
+// Every instance has its own transform, frame offset and modulate color,
+// each distinct frame is evaluated once per tick and shared by all
+// instances showing it. Instance frames are quantized to whole frames,
+// animation events are not emitted.
+class FlashMultiPlayer: public FlashPlayer {
+    GDCLASS(FlashMultiPlayer, FlashPlayer);
+
+    Vector<Transform2D> instance_transforms;
+    Vector<float> instance_frame_offsets;
+    Vector<Color> instance_colors;
+
+    // per tick frame snapshots, `frame_slots` maps frame index to snapshot
+    HashMap<int, int> frame_slots;
+    LocalVector<FlashBakedFrame> snapshots;
+    LocalVector<int> instance_slots;
+
+    int get_instance_frame(int p_instance, int p_duration) const;
+    void instances_changed();
+
+protected:
+    static void _bind_methods();
+
+public:
+    int get_instance_count() const { return instance_transforms.size(); }
+    void set_instance_count(int p_count);
+    Transform2D get_instance_transform(int p_instance) const;
+    void set_instance_transform(int p_instance, const Transform2D &p_transform);
+    float get_instance_frame_offset(int p_instance) const;
+    void set_instance_frame_offset(int p_instance, float p_frame_offset);
+    Color get_instance_color(int p_instance) const;
+    void set_instance_color(int p_instance, const Color &p_color);
+
+    Array get_instance_transforms() const;
+    void set_instance_transforms(const Array &p_transforms);
+    PackedFloat32Array get_instance_frame_offsets() const;
+    void set_instance_frame_offsets(const PackedFloat32Array &p_frame_offsets);
+    PackedColorArray get_instance_colors() const;
+    void set_instance_colors(const PackedColorArray &p_colors);
+
+    virtual bool get_local_bounds(Rect2 &r_bounds) override;
+    virtual void _animation_evaluate() override;
+};
+
+#endif
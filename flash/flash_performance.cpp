@@ -0,0 +1,106 @@
+// MIT License
+
+// Copyright (c) 2021 Yakov Borevich, Funexpected LLC
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "flash_performance.h"
+
+#include <core/config/engine.h>
+#include <core/object/callable_method_pointer.h>
+#include <main/performance.h>
+
+FlashPerformance::FrameCounter FlashPerformance::counters[FlashPerformance::COUNTER_MAX];
+SafeNumeric<int> FlashPerformance::players;
+Mutex FlashPerformance::rollover_mutex;
+bool FlashPerformance::monitors_registered = false;
+
+void FlashPerformance::_rollover(FrameCounter &p_counter, uint64_t p_frame) {
+    MutexLock lock(rollover_mutex);
+    uint64_t frame = p_counter.frame.get();
+    if (frame == p_frame) return;
+    int64_t value = p_counter.value.get();
+    p_counter.value.sub(value);
+    p_counter.last_frame = frame;
+    p_counter.last_value = value;
+    p_counter.frame.set(p_frame);
+}
+
+void FlashPerformance::add(Counter p_counter, int64_t p_value) {
+    FrameCounter &counter = counters[p_counter];
+    uint64_t frame = Engine::get_singleton()->get_process_frames();
+    if (counter.frame.get() != frame) _rollover(counter, frame);
+    counter.value.add(p_value);
+}
+
+int64_t FlashPerformance::get(Counter p_counter) {
+    FrameCounter &counter = counters[p_counter];
+    uint64_t frame = Engine::get_singleton()->get_process_frames();
+    MutexLock lock(rollover_mutex);
+    uint64_t counter_frame = counter.frame.get();
+    // nothing added yet in this frame, the running value is the finished frame
+    if (counter_frame + 1 == frame) return counter.value.get();
+    if (counter_frame == frame && counter.last_frame + 1 == frame) return counter.last_value;
+    return 0;
+}
+
+Variant FlashPerformance::_get_counter(int p_counter) {
+    return get((Counter)p_counter);
+}
+
+Variant FlashPerformance::_get_process_time() {
+    return get(PROCESS_USEC) / 1000.0;
+}
+
+Variant FlashPerformance::_get_players() {
+    return players.get();
+}
+
+void FlashPerformance::player_entered() {
+    players.increment();
+    register_monitors();
+}
+
+void FlashPerformance::player_exited() {
+    players.decrement();
+}
+
+void FlashPerformance::register_monitors() {
+    // registered with the first player, Performance is not there yet while modules
+    // initialize; monitors call static functions, so they never need removing
+    if (monitors_registered || Performance::get_singleton() == nullptr) return;
+    monitors_registered = true;
+    Performance *performance = Performance::get_singleton();
+    static const char *names[COUNTER_MAX] = {
+        "Flash/Triangles",
+        "Flash/Vertices",
+        "Flash/Mesh Uploads",
+        "Flash/Bytes Uploaded",
+        "",
+        "Flash/Mask Items"
+    };
+    for (int i=0; i<COUNTER_MAX; i++) {
+        if (i == PROCESS_USEC) continue;
+        Vector<Variant> args;
+        args.push_back(i);
+        performance->add_custom_monitor(names[i], callable_mp_static(&FlashPerformance::_get_counter), args);
+    }
+    performance->add_custom_monitor("Flash/Animation Process (ms)", callable_mp_static(&FlashPerformance::_get_process_time), Vector<Variant>());
+    performance->add_custom_monitor("Flash/Active Players", callable_mp_static(&FlashPerformance::_get_players), Vector<Variant>());
+}
@@ -0,0 +1,71 @@
+// MIT License
+
+// Copyright (c) 2021 Yakov Borevich, Funexpected LLC
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FLASH_PERFORMANCE_H
+#define FLASH_PERFORMANCE_H
+
+#include <core/os/mutex.h>
+#include <core/templates/safe_refcount.h>
+#include <core/variant/variant.h>
+
+// Counters behind the "Flash/..." custom monitors of the Performance singleton,
+// aggregated over all players. Values are added from any thread during a process
+// frame and reported for the last finished one, gauges report the current value.
+class FlashPerformance {
+public:
+    enum Counter {
+        TRIANGLES,
+        VERTICES,
+        MESH_UPLOADS,
+        BYTES_UPLOADED,
+        PROCESS_USEC,
+        MASK_ITEMS,
+        COUNTER_MAX
+    };
+
+private:
+    struct FrameCounter {
+        SafeNumeric<uint64_t> frame;
+        SafeNumeric<int64_t> value;
+        uint64_t last_frame = 0;
+        int64_t last_value = 0;
+    };
+
+    static FrameCounter counters[COUNTER_MAX];
+    static SafeNumeric<int> players;
+    static Mutex rollover_mutex;
+    static bool monitors_registered;
+
+    static void _rollover(FrameCounter &p_counter, uint64_t p_frame);
+    static Variant _get_counter(int p_counter);
+    static Variant _get_process_time();
+    static Variant _get_players();
+
+public:
+    static void add(Counter p_counter, int64_t p_value);
+    static int64_t get(Counter p_counter);
+    static void player_entered();
+    static void player_exited();
+    static void register_monitors();
+};
+
+#endif
@@ -22,7 +22,10 @@
 
 
 #include "flash_player.h"
+#include "flash_player_server.h"
+#include "flash_performance.h"
 #include "core/math/geometry_2d.h"
+#include <core/os/os.h>
 
 #ifdef TOOLS_ENABLED
 #include <core/config/engine.h>
@@ -33,6 +36,7 @@ RID FlashPlayer::flash_shader = RID();
 void FlashPlayer::_notification(int p_what) {
     switch (p_what) {
         case NOTIFICATION_ENTER_TREE : {
+            FlashPerformance::player_entered();
             if (!resource.is_valid() || !resource->get_atlas().is_valid()) {
                 if (!resource.is_valid()) {
                     print_line("Warning: FlashDocument resource not set - please set it later");
@@ -74,59 +78,50 @@ void FlashPlayer::_notification(int p_what) {
                 }
                 return;
             }
-            if (!clipping_texture.is_valid()) {
-                clipping_texture.instantiate();
-                clipping_data.instantiate();
-                clipping_data->initialize_data(32, 32, false, Image::FORMAT_RGBA8);
-                // 验证Image数据有效性
-                if (clipping_data->is_empty()) {
-                    print_line(String("ERROR: Clipping data is empty after initialization"));
-                    return;
-                }
-
-                clipping_texture->create_from_image(clipping_data);
-                RS::get_singleton()->material_set_param(flash_material, "CLIPPING_TEXTURE", clipping_texture->get_rid());
-            }
-            if (resource.is_valid()) {
-                RS::get_singleton()->material_set_param(flash_material, "ATLAS_SIZE", resource->get_atlas_size());
-                RS::get_singleton()->material_set_param(flash_material, "ATLAS", resource->get_atlas()->get_rid());
-            }
+            RS::get_singleton()->canvas_item_set_material(get_canvas_item(), resource->get_material());
+        } break;
+        case NOTIFICATION_EXIT_TREE: {
+            FlashPerformance::player_exited();
         } break;
+
         case NOTIFICATION_READY: {
             set_process(true);
         } break;
 
         case NOTIFICATION_PROCESS: {
             performance_triangles_generated = 0;
+            _update_culled();
+            if (culled && offscreen_process_mode == OFFSCREEN_PROCESS_PAUSE) break;
             if (playing && active_symbol.is_valid()) {
-                advance(get_process_delta_time(), false, true);
+                float delta = get_process_delta_time();
+                if (_lod_step(delta)) advance(delta, false, true);
             }
         } break;
 
         case NOTIFICATION_DRAW: {
-            if (active_symbol.is_valid() && points.size() > 0 && resource.is_valid()) {
+            if (active_symbol.is_valid() && vertex_count > 0 && resource.is_valid() && resource->get_atlas().is_valid()) {
                 update_clipping_data();
-                RS::get_singleton()->mesh_clear(mesh);
-                Array arrays;
-                arrays.resize(Mesh::ARRAY_MAX);
-                arrays[Mesh::ARRAY_VERTEX] = points;
-                arrays[Mesh::ARRAY_INDEX] = indices;
-                arrays[Mesh::ARRAY_COLOR] = colors;
-                arrays[Mesh::ARRAY_TEX_UV] = uvs;
-                RS::get_singleton()->mesh_add_surface_from_arrays(
-                    mesh,
-                    RS::PRIMITIVE_TRIANGLES,
-                    arrays, Array(), Dictionary(),
-                    RS::ARRAY_FLAG_USE_2D_VERTICES
-                );
-                RS::get_singleton()->canvas_item_add_mesh(get_canvas_item(), mesh);
-                performance_triangles_drawn = indices.size() / 3;
+                update_mesh();
+                // the material is shared by the players of the document, the item texture holds the mask rows
+                RS::get_singleton()->canvas_item_add_mesh(get_canvas_item(), mesh, Transform2D(), Color(1, 1, 1, 1), clipping_texture->get_rid());
+                performance_triangles_drawn = index_count / 3;
+                FlashPerformance::add(FlashPerformance::TRIANGLES, performance_triangles_drawn);
+                FlashPerformance::add(FlashPerformance::VERTICES, vertex_count);
             }
         } break;
 
         case NOTIFICATION_VISIBILITY_CHANGED: {
             performance_triangles_drawn = 0;
             performance_triangles_generated = 0;
+            _update_culled();
+        } break;
+
+        case NOTIFICATION_OS_MEMORY_WARNING: {
+            // drop content of lazily loaded symbols nobody drew lately, other
+            // players may evaluate them now, so it is done on the next flush
+            if (resource.is_valid() && FlashPlayerServer::get_singleton() != nullptr) {
+                FlashPlayerServer::get_singleton()->queue_eviction(resource.ptr());
+            }
         } break;
     }
 };
@@ -145,65 +140,107 @@ void FlashPlayer::override_frame(String p_symbol, Variant p_value) {
     }
 }
 void FlashPlayer::set_variant(String variant, Variant value) {
-    if (value == Variant() || value == "[default]") {
-        if(active_variants.has(variant)) active_variants.erase(variant);
-    } else {
-        active_variants[variant] = value;
+    if (!resource.is_valid()) {
+        pending_variants[variant] = value;
+        return;
     }
-
-    if (!resource.is_valid()) return;
-    Dictionary variants = resource->get_variants();
-    if (variants.has(variant)) {
-        Dictionary symbols_by_variant = variants[variant];
-        if (symbols_by_variant.has(value)) {
-            if (value == "[default]") {
-                for (int i=0; i<symbols_by_variant.size(); i++) {
-                    Ref<FlashTimeline> symbol = resource->get_symbols().get(symbols_by_variant.get_key_at_index(i), Variant());
-                    if (symbol.is_null() || symbol->get_variation_idx() < 0) continue;
-                    frame_overrides.set(symbol->get_variation_idx(), -1);
-                }
-            } else {
-                Dictionary frames_by_symbol = symbols_by_variant[value];
-                for (int i=0; i<frames_by_symbol.size(); i++) {
-                    String token = frames_by_symbol.get_key_at_index(i);
-                    Ref<FlashTimeline> symbol = resource->get_symbols().get(token, Variant());
-                    if (symbol.is_null() || symbol->get_variation_idx() < 0) continue;
-                    int frame_value = frames_by_symbol.get_value_at_index(i);
-                    frame_overrides.set(symbol->get_variation_idx(), frame_value);
-                }
-            }
+    int slot = resource->find_variant_slot(variant);
+    ERR_FAIL_COND_MSG(slot < 0, "Unknown variant " + variant);
+    const int *option = resource->get_variant_slot(slot).option_ids.getptr(value);
+    set_variant_by_id(slot, option != NULL ? *option : -1);
+}
+void FlashPlayer::set_variant_by_id(int p_slot, int p_option) {
+    ERR_FAIL_COND(!resource.is_valid());
+    ERR_FAIL_INDEX(p_slot, active_variants.size());
+    const FlashVariantSlot &slot = resource->get_variant_slot(p_slot);
+    if (p_option < 0 || p_option >= slot.options.size()) p_option = -1;
+    int current = active_variants[p_slot];
+    if (current == p_option) return;
+
+    // symbols of the previous option return to their own timeline
+    if (current >= 0) {
+        const Vector<Vector2i> &overrides = slot.overrides[current];
+        for (int i=0; i<overrides.size(); i++) {
+            frame_overrides.set(overrides[i].x, -1);
         }
     }
+    if (p_option >= 0) {
+        const Vector<Vector2i> &overrides = slot.overrides[p_option];
+        for (int i=0; i<overrides.size(); i++) {
+            frame_overrides.set(overrides[i].x, overrides[i].y);
+        }
+    }
+    active_variants.write[p_slot] = p_option;
+    tracks_dirty = true;
     queue_process();
 }
 String FlashPlayer::get_variant(String variant) const {
-    return active_variants.has(variant) ? active_variants[variant] : "[default]";
+    if (!resource.is_valid()) return pending_variants.has(variant) ? String(pending_variants[variant]) : String("[default]");
+    int slot = resource->find_variant_slot(variant);
+    if (slot < 0 || slot >= active_variants.size() || active_variants[slot] < 0) return "[default]";
+    return resource->get_variant_slot(slot).options[active_variants[slot]];
 }
 
 void FlashPlayer::set_clip(String clip, Variant value) {
-    if (!resource.is_valid()) return;
-    if (value == Variant() || value == "[default]") {
-        if(clips_state.has(clip)) clips_state.erase(clip);
-        if(active_clips.has(clip)) active_clips.erase(clip);
-    } else {
-        String *track_clip = active_clips.getptr(clip);
-        if (track_clip == NULL || Variant(*track_clip) == value) return;
-        active_clips[clip] = value;
-        Array timelines = resource->get_symbols().values();
-        for (int i=0; i<timelines.size(); i++) {
-            Ref<FlashTimeline> tl = timelines[i];
-            if (clip != tl->get_clips_header()) continue;
-            Vector2 clip_data = tl->get_clips()[value];
-            clips_state[clip] = Vector3(clip_data.x, clip_data.y, 0.0);
-            break;
-        }
+    if (!resource.is_valid()) {
+        pending_clips[clip] = value;
+        return;
     }
+    int track = resource->find_clip_track(clip);
+    ERR_FAIL_COND_MSG(track < 0, "Unknown clip track " + clip);
+    set_clip_by_id(track, resource->find_clip(track, value));
+}
+
+void FlashPlayer::set_clip_by_id(int p_track, int p_clip) {
+    ERR_FAIL_INDEX(p_track, active_clips.size());
+    if (p_clip < 0) p_clip = -1;
+    if (active_clips[p_track] == p_clip) return;
+    activate_clip(p_track, p_clip);
     tracks_dirty = true;
     queue_process();
 }
 
+void FlashPlayer::activate_clip(int p_track, int p_clip) {
+    const FlashClipTrack &track = resource->get_clip_track(p_track);
+    ERR_FAIL_COND(p_clip >= track.clips.size());
+    int current = active_clips[p_track];
+    if (current < 0 && p_clip >= 0) active_clips_count++;
+    if (current >= 0 && p_clip < 0) active_clips_count--;
+    active_clips.write[p_track] = p_clip;
+    if (p_clip >= 0) {
+        Vector2 clip_data = track.ranges[p_clip];
+        clips_state.write[p_track] = Vector3(clip_data.x, clip_data.y, 0.0);
+    }
+}
+
 String FlashPlayer::get_clip(String clip) const {
-    return active_clips.has(clip) ? active_clips[clip] : "[default]";
+    if (!resource.is_valid()) return pending_clips.has(clip) ? String(pending_clips[clip]) : String("[default]");
+    int track = resource->find_clip_track(clip);
+    int clip_id = get_clip_id(track);
+    return clip_id >= 0 ? resource->get_clip_track(track).clips[clip_id] : "[default]";
+}
+
+int FlashPlayer::get_clip_id(int p_track) const {
+    if (p_track < 0 || p_track >= active_clips.size()) return -1;
+    return active_clips[p_track];
+}
+
+int FlashPlayer::find_clip_track(const String &p_track) const {
+    return resource.is_valid() ? resource->find_clip_track(p_track) : -1;
+}
+
+int FlashPlayer::find_clip(int p_track, const String &p_clip) const {
+    return resource.is_valid() ? resource->find_clip(p_track, p_clip) : -1;
+}
+
+int FlashPlayer::find_variant_slot(const String &p_variant) const {
+    return resource.is_valid() ? resource->find_variant_slot(p_variant) : -1;
+}
+
+int FlashPlayer::find_variant_option(int p_slot, const String &p_option) const {
+    if (!resource.is_valid() || p_slot < 0 || p_slot >= resource->get_variant_slots_count()) return -1;
+    const int *option = resource->get_variant_slot(p_slot).option_ids.getptr(p_option);
+    return option != NULL ? *option : -1;
 }
 
 float FlashPlayer::get_symbol_frame(FlashTimeline* p_symbol, float p_default) {
@@ -211,9 +248,11 @@ float FlashPlayer::get_symbol_frame(FlashTimeline* p_symbol, float p_default) {
         return p_default;
     }
 
-    Vector3 *clip = clips_state.getptr(p_symbol->get_clips_header());
-    if (clip != NULL) {
-        return clip->x + clip->z;        
+    // ids are interned at document setup, no hashing per instance
+    int track = p_symbol->get_clip_track_idx();
+    if (track >= 0 && track < active_clips.size() && active_clips[track] >= 0) {
+        const Vector3 &clip = clips_state[track];
+        return clip.x + clip.z;
     }
 
     if (p_symbol->get_variation_idx() < 0) {
@@ -280,65 +319,31 @@ void FlashPlayer::_get_property_list(List<PropertyInfo> *p_list) const {
         }
         p_list->push_back(PropertyInfo(Variant::STRING, "variants/" + key, PROPERTY_HINT_ENUM, options_string));
     }
-    HashMap<String, Vector<String>> clips;
-    Array timelines = resource->get_symbols().values();
-    for (int i=0; i<timelines.size(); i++) {
-        Ref<FlashTimeline> tl = timelines[i];
-        String clips_header = tl->get_clips_header();
-        if (clips_header == String()) continue;
-        Array clip_names = tl->get_clips().keys();
-        for (int i=0; i<clip_names.size(); i++) {
-            String clip_name = clip_names[i];
-            if (clips[clips_header].find(clip_name) < 0) {
-                clips[clips_header].push_back(clip_name);
-            }
-        }
-    }
-    List<String> clip_keys;
-    HashMap<String, PackedStringArray>::ConstIterator E = clips.begin();
-    while (E) {
-        String clips_key = E->key;
-        Vector<String> timeline_clips = clips[clips_key];
+    for (int i=0; i<resource->get_clip_tracks_count(); i++) {
+        const FlashClipTrack &track = resource->get_clip_track(i);
+        Vector<String> timeline_clips = track.clips;
         timeline_clips.insert(0, "[default]");
-        p_list->push_back(PropertyInfo(Variant::STRING, "clips/" + clips_key, PROPERTY_HINT_ENUM, String(",").join(timeline_clips)));
-        ++E;
+        p_list->push_back(PropertyInfo(Variant::STRING, "clips/" + track.name, PROPERTY_HINT_ENUM, String(",").join(timeline_clips)));
     }
 }
 
 PackedStringArray FlashPlayer::get_clips_tracks() const {
     PackedStringArray result;
-    Dictionary unique;
     if (!resource.is_valid()) return result;
-    Array timelines = resource->get_symbols().values();
-    for (int i=0; i<timelines.size(); i++) {
-        Ref<FlashTimeline> tl = timelines[i];
-        String clips_track = tl->get_clips_header();
-        if (clips_track == String()) continue;
-        if (!unique.has(clips_track)) {
-            unique[clips_track] = true;
-            result.push_back(clips_track);
-        }
+    for (int i=0; i<resource->get_clip_tracks_count(); i++) {
+        result.push_back(resource->get_clip_track(i).name);
     }
     return result;
 }
 
 PackedStringArray FlashPlayer::get_clips_for_track(const String &track) const {
     PackedStringArray result;
-    Dictionary cache;
     if (!resource.is_valid()) return result;
-    Array timelines = resource->get_symbols().values();
-    for (int i=0; i<timelines.size(); i++) {
-        Ref<FlashTimeline> tl = timelines[i];
-        String clips_track = tl->get_clips_header();
-        if (clips_track != track) continue;
-        Array clip_names = tl->get_clips().keys();
-        for (int i=0; i<clip_names.size(); i++) {
-            String clip_name = clip_names[i];
-            if (!cache.has(clip_name)) {
-                cache[clip_name] = true;
-                result.push_back(clip_name);
-            }
-        }
+    int track_id = resource->find_clip_track(track);
+    if (track_id < 0) return result;
+    const Vector<String> &clips = resource->get_clip_track(track_id).clips;
+    for (int i=0; i<clips.size(); i++) {
+        result.push_back(clips[i]);
     }
     return result;
 }
@@ -403,6 +408,10 @@ void FlashPlayer::set_resource(const Ref<FlashDocument> &doc) {
     playback_end = 0;
     frame_overrides.clear();
     active_variants.clear();
+    active_clips.clear();
+    clips_state.clear();
+    active_clips_count = 0;
+    clear_layer_cache();
     if (!resource.is_valid() || !resource->get_atlas().is_valid()) {
         if (!resource.is_valid()) {
             print_line(String("invalid flash atlas: FlashDocument resource is not valid"));
@@ -440,21 +449,36 @@ void FlashPlayer::set_resource(const Ref<FlashDocument> &doc) {
                 print_line(String("Document path is empty - resource may not be loaded properly"));
             }
         }
-        return;
     }
     if (resource.is_valid()) {
-
+        // sized even without an atlas, so variants and clips set later are kept
         frame_overrides.resize(resource->get_variated_symbols_count());
         for (int i=0; i<frame_overrides.size(); i++) {
             frame_overrides.set(i, -1); 
         }
+        active_variants.resize(resource->get_variant_slots_count());
+        active_variants.fill(-1);
+        active_clips.resize(resource->get_clip_tracks_count());
+        active_clips.fill(-1);
+        clips_state.resize(resource->get_clip_tracks_count());
         active_symbol = resource->get_main_timeline();
         if (active_symbol.is_valid())
             playback_end = active_symbol->get_duration();
-        RS::get_singleton()->material_set_param(flash_material, "ATLAS_SIZE", resource->get_atlas_size());
-        RS::get_singleton()->material_set_param(flash_material, "ATLAS", resource->get_atlas()->get_rid());
+        // material is shared by all players of the document, nothing is drawn without an atlas
+        bool has_atlas = resource->get_atlas().is_valid();
+        RS::get_singleton()->canvas_item_set_material(get_canvas_item(), has_atlas ? resource->get_material() : RID());
+        for (const KeyValue<String, Variant> &E : pending_variants) {
+            set_variant(E.key, E.value);
+        }
+        for (const KeyValue<String, Variant> &E : pending_clips) {
+            set_clip(E.key, E.value);
+        }
+        pending_variants.clear();
+        pending_clips.clear();
     } else {
         frame_overrides.resize(0);
+        active_symbol.unref();
+        RS::get_singleton()->canvas_item_set_material(get_canvas_item(), RID());
     }
     queue_process();
     notify_property_list_changed();
@@ -479,6 +503,15 @@ void FlashPlayer::_bind_methods() {
     ClassDB::bind_method(D_METHOD("set_variant", "variant", "value"), &FlashPlayer::set_variant);
     ClassDB::bind_method(D_METHOD("get_variant", "variant"), &FlashPlayer::get_variant);
     ClassDB::bind_method(D_METHOD("get_variants"), &FlashPlayer::get_variants);
+    ClassDB::bind_method(D_METHOD("find_variant_slot", "variant"), &FlashPlayer::find_variant_slot);
+    ClassDB::bind_method(D_METHOD("find_variant_option", "slot", "option"), &FlashPlayer::find_variant_option);
+    ClassDB::bind_method(D_METHOD("set_variant_by_id", "slot", "option"), &FlashPlayer::set_variant_by_id);
+    ClassDB::bind_method(D_METHOD("set_clip", "track", "clip"), &FlashPlayer::set_clip);
+    ClassDB::bind_method(D_METHOD("get_clip", "track"), &FlashPlayer::get_clip);
+    ClassDB::bind_method(D_METHOD("find_clip_track", "track"), &FlashPlayer::find_clip_track);
+    ClassDB::bind_method(D_METHOD("find_clip", "track_id", "clip"), &FlashPlayer::find_clip);
+    ClassDB::bind_method(D_METHOD("set_clip_by_id", "track_id", "clip_id"), &FlashPlayer::set_clip_by_id);
+    ClassDB::bind_method(D_METHOD("get_clip_id", "track_id"), &FlashPlayer::get_clip_id);
     ClassDB::bind_method(D_METHOD("set_resource", "resource"), &FlashPlayer::set_resource);
     ClassDB::bind_method(D_METHOD("get_resource"), &FlashPlayer::get_resource);
     ClassDB::bind_method(D_METHOD("get_duration"), &FlashPlayer::get_duration, DEFVAL(String()), DEFVAL(String()));
@@ -487,6 +520,21 @@ void FlashPlayer::_bind_methods() {
     ClassDB::bind_method(D_METHOD("set_active_clip", "active_clip"), &FlashPlayer::set_active_clip);
     ClassDB::bind_method(D_METHOD("get_active_clip"), &FlashPlayer::get_active_clip);
 
+    ClassDB::bind_method(D_METHOD("set_offscreen_process_mode", "mode"), &FlashPlayer::set_offscreen_process_mode);
+    ClassDB::bind_method(D_METHOD("get_offscreen_process_mode"), &FlashPlayer::get_offscreen_process_mode);
+    ClassDB::bind_method(D_METHOD("is_culled"), &FlashPlayer::is_culled);
+    ClassDB::bind_method(D_METHOD("get_bounds"), &FlashPlayer::get_bounds);
+    ClassDB::bind_method(D_METHOD("set_lod_enabled", "enabled"), &FlashPlayer::set_lod_enabled);
+    ClassDB::bind_method(D_METHOD("is_lod_enabled"), &FlashPlayer::is_lod_enabled);
+    ClassDB::bind_method(D_METHOD("set_lod_update_interval", "interval"), &FlashPlayer::set_lod_update_interval);
+    ClassDB::bind_method(D_METHOD("get_lod_update_interval"), &FlashPlayer::get_lod_update_interval);
+    ClassDB::bind_method(D_METHOD("set_lod_max_fps", "max_fps"), &FlashPlayer::set_lod_max_fps);
+    ClassDB::bind_method(D_METHOD("get_lod_max_fps"), &FlashPlayer::get_lod_max_fps);
+    ClassDB::bind_method(D_METHOD("set_lod_screen_size", "screen_size"), &FlashPlayer::set_lod_screen_size);
+    ClassDB::bind_method(D_METHOD("get_lod_screen_size"), &FlashPlayer::get_lod_screen_size);
+
+    ClassDB::bind_method(D_METHOD("bake"), &FlashPlayer::bake);
+
     ClassDB::bind_method(D_METHOD("_animation_process"), &FlashPlayer::_animation_process);
 
     ClassDB::bind_method(D_METHOD("_sort_clips"), &FlashPlayer::_sort_clips);
@@ -497,6 +545,17 @@ void FlashPlayer::_bind_methods() {
     ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "resource", PROPERTY_HINT_RESOURCE_TYPE, "FlashDocument"), "set_resource", "get_resource");
     ADD_PROPERTY(PropertyInfo(Variant::STRING, "active_symbol", PROPERTY_HINT_ENUM, ""), "set_active_symbol", "get_active_symbol");
     ADD_PROPERTY(PropertyInfo(Variant::STRING, "active_clip", PROPERTY_HINT_ENUM, ""), "set_active_clip", "get_active_clip");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "offscreen_process_mode", PROPERTY_HINT_ENUM, "Always,Advance,Pause"), "set_offscreen_process_mode", "get_offscreen_process_mode");
+    ADD_GROUP("LOD", "lod_");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "lod_enabled"), "set_lod_enabled", "is_lod_enabled");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "lod_update_interval", PROPERTY_HINT_RANGE, "1,16,1"), "set_lod_update_interval", "get_lod_update_interval");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "lod_max_fps", PROPERTY_HINT_RANGE, "0,240,1"), "set_lod_max_fps", "get_lod_max_fps");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "lod_screen_size", PROPERTY_HINT_RANGE, "0,4096,1,suffix:px"), "set_lod_screen_size", "get_lod_screen_size");
+    ADD_GROUP("", "");
+
+    BIND_ENUM_CONSTANT(OFFSCREEN_PROCESS_ALWAYS);
+    BIND_ENUM_CONSTANT(OFFSCREEN_PROCESS_ADVANCE);
+    BIND_ENUM_CONSTANT(OFFSCREEN_PROCESS_PAUSE);
 
     ADD_SIGNAL(MethodInfo("resource_changed"));
     ADD_SIGNAL(MethodInfo("animation_completed"));
@@ -612,42 +671,177 @@ PackedStringArray FlashPlayer::get_clips(String p_symbol) const {
     return result;
 }
 
+void FlashPlayer::set_offscreen_process_mode(OffscreenProcessMode p_mode) {
+    offscreen_process_mode = p_mode;
+    _update_culled();
+}
+
+bool FlashPlayer::get_local_bounds(Rect2 &r_bounds) {
+    return active_symbol.is_valid() && active_symbol->get_bounds(r_bounds);
+}
+
+Rect2 FlashPlayer::get_bounds() {
+    Rect2 bounds;
+    get_local_bounds(bounds);
+    return bounds;
+}
+
+void FlashPlayer::_update_culled() {
+    bool was_culled = culled;
+    culled = false;
+    screen_size = -1.0;
+    bool cull = offscreen_process_mode != OFFSCREEN_PROCESS_ALWAYS && is_inside_tree();
+#ifdef TOOLS_ENABLED
+    if (Engine::get_singleton()->is_editor_hint()) cull = false;
+#endif
+    bool measure = lod_enabled && lod_screen_size > 0.0 && is_inside_tree();
+    if (cull && !is_visible_in_tree()) {
+        culled = true;
+    } else if (cull || measure) {
+        // unknown bounds keep the player processing
+        Rect2 bounds;
+        if (get_local_bounds(bounds)) {
+            Rect2 screen_bounds = get_global_transform_with_canvas().xform(bounds);
+            screen_size = MAX(screen_bounds.size.x, screen_bounds.size.y);
+            if (cull) culled = !get_viewport_rect().intersects(screen_bounds, true);
+        }
+    }
+    // catch up with the time advanced while culled
+    if (was_culled && !culled) queue_process();
+}
+
+bool FlashPlayer::_lod_step(float &r_delta) {
+    if (!lod_enabled || (lod_update_interval <= 1 && lod_max_fps <= 0.0 && lod_screen_size <= 0.0)) {
+        lod_skipped_time = 0.0;
+        return true;
+    }
+    lod_skipped_time += r_delta;
+    lod_skipped_frames++;
+
+    int interval = lod_update_interval;
+    if (lod_screen_size > 0.0 && screen_size >= 0.0 && screen_size < lod_screen_size) {
+        // small players step down with their size on screen, up to 8 times
+        interval *= MIN((int)Math::ceil(lod_screen_size / MAX(screen_size, 1.0f)), 8);
+    }
+    if (lod_skipped_frames < interval) return false;
+    if (lod_max_fps > 0.0 && lod_skipped_time < 1.0 / lod_max_fps - 0.001) return false;
+
+    r_delta = lod_skipped_time;
+    lod_skipped_time = 0.0;
+    lod_skipped_frames = 0;
+    return true;
+}
+
 void FlashPlayer::queue_process(float p_delta) {
+    if (culled) {
+        // skip the tree, only events of the active symbol itself are reported
+        if (p_delta > 0.0 && active_symbol.is_valid()) {
+            events.clear();
+            active_symbol->process_events(this, frame, p_delta);
+            _emit_animation_events();
+        }
+        return;
+    }
     queued_delta = MAX(p_delta, queued_delta);
     if (!animation_process_queued) {
         animation_process_queued = true;
-        call_deferred("_animation_process");
+        if (FlashPlayerServer::get_singleton() != nullptr) {
+            FlashPlayerServer::get_singleton()->queue_player(this);
+        } else {
+            call_deferred("_animation_process");
+        }
     }
 }
 
 void FlashPlayer::_animation_process() {
+    if (!_animation_begin()) return;
+    uint64_t start = OS::get_singleton()->get_ticks_usec();
+    _animation_evaluate();
+    FlashPerformance::add(FlashPerformance::PROCESS_USEC, OS::get_singleton()->get_ticks_usec() - start);
+    _animation_end();
+}
+
+bool FlashPlayer::_animation_begin() {
     if (processed_frame == frame && !tracks_dirty) {
         animation_process_queued = false;
         queued_delta = 0.0;
-        return;
+        return false;
     }
     events.clear();
     masks.clear();
     clipping_cache.clear();
     clipping_items.clear();
     processed_frame = frame;
-    indices.resize(0);
-    points.resize(0);
-    colors.resize(0);
-    uvs.resize(0);
+    mesh_dirty = true;
+    clear_geometry();
 
     if (!active_symbol.is_valid()) {
         queue_redraw();
         animation_process_queued = false;
         queued_delta = 0.0;
         tracks_dirty = false;
-        return;
+        return false;
     }
+    use_baked_frames = can_use_baked_frames();
+    return true;
+}
 
-    active_symbol->animation_process(this, frame, queued_delta);
-    queue_redraw();
-    performance_triangles_generated = indices.size() / 3;
+void FlashPlayer::_animation_evaluate() {
+    // may run on a worker thread, touch only this player and read-only resource data
+    if (use_baked_frames) {
+        clear_layer_cache();
+        active_symbol->process_events(this, frame, queued_delta);
+        int duration = MAX(active_symbol->get_duration(), 1);
+        int frame_idx = CLAMP((int)Math::floor(frame), 0, duration - 1);
+        float amount = frame - Math::floor(frame);
+        FlashBakedFrame current = get_baked_frame(frame_idx);
+        FlashBakedFrame next;
+        if (resource->is_bake_interpolation() && amount > 0.0 && frame_idx + 1 < duration) {
+            next = get_baked_frame(frame_idx + 1);
+        }
+
+        points = current.points;
+        uvs = current.uvs;
+        colors = current.colors;
+        indices = current.indices;
+        vertex_count = points.size();
+        index_count = indices.size();
+        clipping_cache.clear();
+        for (int i=0; i<current.clipping.size(); i++) {
+            clipping_cache.push_back(current.clipping[i]);
+        }
+
+        // lerp only between frames with the same topology and textures
+        if (next.valid
+            && next.points.size() == points.size()
+            && next.indices.size() == indices.size()
+            && next.clipping.size() == current.clipping.size()
+            && memcmp(next.indices.ptr(), indices.ptr(), sizeof(int) * indices.size()) == 0
+            && memcmp(next.uvs.ptr(), uvs.ptr(), sizeof(Vector2) * uvs.size()) == 0) {
+            Vector2 *w_points = points.ptrw();
+            Color *w_colors = colors.ptrw();
+            const Vector2 *r_next_points = next.points.ptr();
+            const Color *r_next_colors = next.colors.ptr();
+            for (int i=0; i<points.size(); i++) {
+                w_points[i] = w_points[i].lerp(r_next_points[i], amount);
+                w_colors[i] = w_colors[i].lerp(r_next_colors[i], amount);
+            }
+        }
+    } else {
+        // previous frame geometry becomes the back buffer layer ranges are copied from
+        SWAP(points, prev_points);
+        SWAP(uvs, prev_uvs);
+        SWAP(colors, prev_colors);
+        SWAP(indices, prev_indices);
+        layer_cache_front = 1 - layer_cache_front;
+        layer_cache[layer_cache_front].clear();
+        layer_cache_active = true;
+        active_symbol->animation_process(this, frame, queued_delta);
+        layer_cache_active = false;
+    }
+}
 
+void FlashPlayer::_emit_animation_events() {
     for (List<String>::Element *E = events.front(); E; E = E->next()) {
         // always emit user events in deferred mode
         // to prevent recursive `animation_process` invocation
@@ -658,11 +852,77 @@ void FlashPlayer::_animation_process() {
             call_deferred("emit_signal", "animation_event", E->get());
 #endif
     }
+}
+
+void FlashPlayer::_animation_end() {
+    clipping_dirty = true;
+    queue_redraw();
+    performance_triangles_generated = index_count / 3;
+    FlashPerformance::add(FlashPerformance::MASK_ITEMS, clipping_cache.size());
+
+    _emit_animation_events();
     animation_process_queued = false;
     queued_delta = 0.0;
     tracks_dirty = false;
 }
 
+bool FlashPlayer::can_use_baked_frames() const {
+    if (!resource.is_valid() || !resource->is_bake_frames()) return false;
+    if (!active_symbol.is_valid() || !active_symbol->is_bakeable()) return false;
+    // clips and variants change nested symbol frames, bake covers defaults only
+    if (active_clips_count > 0) return false;
+    for (int i=0; i<frame_overrides.size(); i++) {
+        if (frame_overrides[i] >= 0) return false;
+    }
+    return true;
+}
+
+FlashBakedFrame FlashPlayer::evaluate_frame(int p_frame) {
+    masks.clear();
+    clipping_cache.clear();
+    clipping_items.clear();
+    clear_geometry();
+    // events were already processed for the current frame, drop the ones
+    // produced while evaluating the frame for the snapshot
+    List<String> pending_events = events;
+    active_symbol->animation_process(this, p_frame, 0.0);
+    events = pending_events;
+
+    FlashBakedFrame frame_data;
+    frame_data.points = points;
+    frame_data.uvs = uvs;
+    frame_data.colors = colors;
+    frame_data.indices = indices;
+    frame_data.points.resize(vertex_count);
+    frame_data.uvs.resize(vertex_count);
+    frame_data.colors.resize(vertex_count);
+    frame_data.indices.resize(index_count);
+    for (List<FlashMaskItem>::Element *E = clipping_cache.front(); E; E = E->next()) {
+        frame_data.clipping.push_back(E->get());
+    }
+    frame_data.valid = true;
+    return frame_data;
+}
+
+FlashBakedFrame FlashPlayer::get_baked_frame(int p_frame) {
+    FlashBakedFrame baked;
+    if (active_symbol->get_baked_frame(p_frame, baked)) return baked;
+
+    clear_layer_cache();
+    baked = evaluate_frame(p_frame);
+    active_symbol->set_baked_frame(p_frame, baked);
+    return baked;
+}
+
+void FlashPlayer::bake() {
+    if (!can_use_baked_frames()) return;
+    for (int i=0; i<MAX(active_symbol->get_duration(), 1); i++) {
+        get_baked_frame(i);
+    }
+    tracks_dirty = true;
+    queue_process();
+}
+
 void FlashPlayer::advance(float p_time, bool p_seek, bool advance_all_frames) {
     if (!active_symbol.is_valid()) return;
     bool animation_completed = false;
@@ -675,16 +935,10 @@ void FlashPlayer::advance(float p_time, bool p_seek, bool advance_all_frames) {
 
     
     if (advance_all_frames) {
-        HashMap<String, Vector3>::ConstIterator E = clips_state.begin();
-        while (E) {
-        // List<String> clip_keys;
-        // clips_state.get_key_list(&clip_keys);
-        // for (List<String>::Element *E = clip_keys.front(); E; E = E->next()) {
-            String clips_key = E->key;
-            Vector3 *clip = clips_state.getptr(clips_key);
-            if (clip == NULL) {
-                continue;
-            }
+        Vector3 *w_clips = clips_state.ptrw();
+        for (int i=0; i<active_clips.size(); i++) {
+            if (active_clips[i] < 0) continue;
+            Vector3 *clip = &w_clips[i];
             if (p_seek) {
                 clip->z = delta;
             } else {
@@ -696,7 +950,6 @@ void FlashPlayer::advance(float p_time, bool p_seek, bool advance_all_frames) {
             } else if (loop) while (clip->z > duration) {
                 clip->z -= duration;
             }
-            ++E;
         }
     }
 
@@ -726,35 +979,32 @@ void FlashPlayer::advance(float p_time, bool p_seek, bool advance_all_frames) {
 
 void FlashPlayer::advance_clip_for_track(const String &p_track, const String &p_clip, float p_time, bool p_seek, float *r_elapsed, float *r_remaining) {
     if (!resource.is_valid()) return;
+    int track = resource->find_clip_track(p_track);
+    int clip = track >= 0 ? resource->find_clip(track, p_clip) : -1;
+    advance_clip_by_id(track, clip, p_time, p_seek, r_elapsed, r_remaining);
+}
+
+void FlashPlayer::advance_clip_by_id(int p_track, int p_clip, float p_time, bool p_seek, float *r_elapsed, float *r_remaining) {
+    if (r_elapsed != NULL) *r_elapsed = 0.0;
+    if (r_remaining != NULL) *r_remaining = 0.0;
+    if (!resource.is_valid() || p_track < 0 || p_track >= active_clips.size()) return;
 
-    if (p_clip == String() || p_clip == "[default]") {
-        if(clips_state.has(p_track)) clips_state.erase(p_track);
-        if(active_clips.has(p_track)) active_clips.erase(p_track);
-        if (r_elapsed != NULL) *r_elapsed = 0.0;
-        if (r_remaining != NULL) *r_remaining = 0.0;
+    if (p_clip < 0) {
+        if (active_clips[p_track] >= 0) {
+            activate_clip(p_track, -1);
+            tracks_dirty = true;
+            queue_process();
+        }
         return;
     }
 
     float delta = p_time*frame_rate;
-    String *current_clip = active_clips.getptr(p_track);
-    if (current_clip == NULL || *current_clip != p_clip) {
-        active_clips[p_track] = p_clip;
-        Array timelines = resource->get_symbols().values();
-        for (int i=0; i<timelines.size(); i++) {
-            Ref<FlashTimeline> tl = timelines[i];
-            if (p_track != tl->get_clips_header()) continue;
-            Vector2 clip_data = tl->get_clips()[p_clip];
-            clips_state[p_track] = Vector3(clip_data.x, clip_data.y, 0.0);
-            break;
-        }
-    }
-
-    Vector3 *current_state = clips_state.getptr(p_track);
-    if (current_state == NULL) {
-        if (r_elapsed != NULL) *r_elapsed = 0.0;
-        if (r_remaining != NULL) *r_remaining = 0.0;
-        return;
+    if (active_clips[p_track] != p_clip) {
+        activate_clip(p_track, p_clip);
+        tracks_dirty = true;
     }
+
+    Vector3 *current_state = &clips_state.write[p_track];
     float duration = current_state->y - current_state->x;
     if (p_seek) {
         if (current_state->z != delta) {
@@ -778,87 +1028,320 @@ void FlashPlayer::advance_clip_for_track(const String &p_track, const String &p_
     if (r_remaining != NULL) *r_remaining = (duration - current_state->z) / frame_rate;
 }
 
-void FlashPlayer::add_polygon(Vector<Vector2> p_points, Vector<Color> p_colors, Vector<Vector2> p_uvs, int p_texture_idx) {
+void FlashPlayer::clear_geometry() {
+    // buffers keep their allocation between frames, only counters are reset
+    vertex_count = 0;
+    index_count = 0;
+}
+
+void FlashPlayer::reserve_geometry(int p_vertices, int p_indices) {
+    if (vertex_count + p_vertices > points.size()) {
+        int capacity = MAX(64, (int)next_power_of_2(vertex_count + p_vertices));
+        points.resize(capacity);
+        colors.resize(capacity);
+        uvs.resize(capacity);
+    }
+    if (index_count + p_indices > indices.size()) {
+        indices.resize(MAX(96, (int)next_power_of_2(index_count + p_indices)));
+    }
+}
+
+void FlashPlayer::clear_layer_cache() {
+    layer_cache[0].clear();
+    layer_cache[1].clear();
+    layer_cache_depth = 0;
+}
+
+bool FlashPlayer::layer_cache_begin(FlashLayerCacheEntry &p_entry, int &r_slot) {
+    // layers nested into a recorded range are covered by it and do not take a slot,
+    // so slots stay stable between frames as long as the tree is evaluated the same way
+    r_slot = -1;
+    if (!layer_cache_active || layer_cache_depth > 0 || is_masking()) return false;
+
+    LocalVector<FlashLayerCacheEntry> &cache = layer_cache[layer_cache_front];
+    const LocalVector<FlashLayerCacheEntry> &prev_cache = layer_cache[1 - layer_cache_front];
+    uint32_t slot = cache.size();
+    p_entry.clipping_offset = clipping_cache.size();
+    p_entry.clipping_size = clipping_items.size();
+
+    if (slot < prev_cache.size() && prev_cache[slot].matches(p_entry)) {
+        const FlashLayerCacheEntry &cached = prev_cache[slot];
+        reserve_geometry(cached.vertex_count, cached.index_count);
+        memcpy(points.ptrw() + vertex_count, prev_points.ptr() + cached.vertex_start, sizeof(Vector2) * cached.vertex_count);
+        memcpy(uvs.ptrw() + vertex_count, prev_uvs.ptr() + cached.vertex_start, sizeof(Vector2) * cached.vertex_count);
+        memcpy(colors.ptrw() + vertex_count, prev_colors.ptr() + cached.vertex_start, sizeof(Color) * cached.vertex_count);
+        int offset = vertex_count - cached.vertex_start;
+        const int *r_indices = prev_indices.ptr() + cached.index_start;
+        int *w_indices = indices.ptrw() + index_count;
+        for (int i=0; i<cached.index_count; i++) {
+            w_indices[i] = r_indices[i] + offset;
+        }
+        p_entry.vertex_start = vertex_count;
+        p_entry.vertex_count = cached.vertex_count;
+        p_entry.index_start = index_count;
+        p_entry.index_count = cached.index_count;
+        vertex_count += cached.vertex_count;
+        index_count += cached.index_count;
+        cache.push_back(p_entry);
+        return true;
+    }
+
+    p_entry.vertex_start = vertex_count;
+    p_entry.vertex_count = 0;
+    p_entry.index_start = index_count;
+    p_entry.index_count = 0;
+    cache.push_back(p_entry);
+    layer_cache_depth++;
+    r_slot = slot;
+    return false;
+}
+
+void FlashPlayer::layer_cache_end(int p_slot) {
+    FlashLayerCacheEntry &entry = layer_cache[layer_cache_front][p_slot];
+    entry.vertex_count = vertex_count - entry.vertex_start;
+    entry.index_count = index_count - entry.index_start;
+    layer_cache_depth--;
+}
+
+void FlashPlayer::add_quad(const Vector2 *p_points, const Color &p_color, const Rect2 &p_uv_rect, int p_texture_idx) {
+    reserve_geometry(4, 6);
+    Vector2 uv_offset(clipping_cache.size(), (clipping_items.size() << 8) | (p_texture_idx & 0xff));
+    Vector2 uv_start = p_uv_rect.position * 0.5 + uv_offset;
+    Vector2 uv_end = (p_uv_rect.position + p_uv_rect.size) * 0.5 + uv_offset;
+
+    int v = vertex_count;
+    Vector2 *w_points = points.ptrw() + v;
+    Color *w_colors = colors.ptrw() + v;
+    Vector2 *w_uvs = uvs.ptrw() + v;
+    int *w_indices = indices.ptrw() + index_count;
+
+    w_points[0] = p_points[0];
+    w_points[1] = p_points[1];
+    w_points[2] = p_points[2];
+    w_points[3] = p_points[3];
+    w_colors[0] = p_color;
+    w_colors[1] = p_color;
+    w_colors[2] = p_color;
+    w_colors[3] = p_color;
+    w_uvs[0] = uv_start;
+    w_uvs[1] = Vector2(uv_end.x, uv_start.y);
+    w_uvs[2] = uv_end;
+    w_uvs[3] = Vector2(uv_start.x, uv_end.y);
+    w_indices[0] = v;
+    w_indices[1] = v + 1;
+    w_indices[2] = v + 2;
+    w_indices[3] = v + 2;
+    w_indices[4] = v + 3;
+    w_indices[5] = v;
+
+    vertex_count += 4;
+    index_count += 6;
+}
+
+void FlashPlayer::add_convex_polygon(const Vector2 *p_points, const Vector2 *p_uvs, int p_count, const Color &p_color, int p_texture_idx) {
+    // triangle fan, convex outlines need no triangulation
+    reserve_geometry(p_count, (p_count - 2) * 3);
+    Vector2 uv_offset(clipping_cache.size(), (clipping_items.size() << 8) | (p_texture_idx & 0xff));
+
+    int v = vertex_count;
+    Vector2 *w_points = points.ptrw() + v;
+    Color *w_colors = colors.ptrw() + v;
+    Vector2 *w_uvs = uvs.ptrw() + v;
+    int *w_indices = indices.ptrw() + index_count;
+    for (int i=0; i<p_count; i++) {
+        w_points[i] = p_points[i];
+        w_colors[i] = p_color;
+        w_uvs[i] = p_uvs[i] * 0.5 + uv_offset;
+    }
+    for (int i=1; i<p_count-1; i++) {
+        *w_indices++ = v;
+        *w_indices++ = v + i;
+        *w_indices++ = v + i + 1;
+    }
+
+    vertex_count += p_count;
+    index_count += (p_count - 2) * 3;
+}
+
+void FlashPlayer::add_polygon(const Vector<Vector2> &p_points, const Vector<Color> &p_colors, const Vector<Vector2> &p_uvs, int p_texture_idx) {
     Vector<int> local_indices = Geometry2D::triangulate_polygon(p_points);
+    reserve_geometry(p_points.size(), local_indices.size());
+    int *w_indices = indices.ptrw();
     for (int i=0; i<local_indices.size(); i++){
-        indices.push_back(local_indices[i] + points.size());
+        w_indices[index_count++] = local_indices[i] + vertex_count;
     }
-    int clipping_id = clipping_cache.size();
-    int clipping_size_with_tex_idx = (clipping_items.size() << 8) | (p_texture_idx & 0xff);
+    Vector2 uv_offset(clipping_cache.size(), (clipping_items.size() << 8) | (p_texture_idx & 0xff));
+    Vector2 *w_points = points.ptrw();
+    Color *w_colors = colors.ptrw();
+    Vector2 *w_uvs = uvs.ptrw();
     for (int i=0; i<p_points.size(); i++) {
-        points.push_back(p_points[i]);
-        colors.push_back(p_colors[i]);
-        uvs.push_back(p_uvs[i] * 0.5 + Vector2(clipping_id, clipping_size_with_tex_idx));
+        w_points[vertex_count] = p_points[i];
+        w_colors[vertex_count] = p_colors[i];
+        w_uvs[vertex_count] = p_uvs[i] * 0.5 + uv_offset;
+        vertex_count++;
     }
 }
 
-void FlashPlayer::queue_animation_event(const String &p_event, bool p_reversed) {
-    if (events.find(p_event) == NULL) {
-        if (p_reversed) {
-            events.push_front(p_event);
-        } else {
-            events.push_back(p_event);
+void FlashPlayer::update_mesh() {
+    if (!mesh_dirty && mesh_vertex_count > 0) return;
+    mesh_dirty = false;
+    RS *rs = RS::get_singleton();
+
+    // surface can be reused while new indices are a prefix of uploaded ones
+    // and padding triangles reference only collapsed (unused) vertices
+    bool topology_changed = vertex_count > mesh_vertex_capacity || index_count > mesh_indices.size();
+    if (!topology_changed) {
+        const int *r_indices = indices.ptr();
+        const int *r_mesh_indices = mesh_indices.ptr();
+        if (index_count > 0 && memcmp(r_indices, r_mesh_indices, sizeof(int) * index_count) != 0) {
+            topology_changed = true;
+        }
+        for (int i=index_count; !topology_changed && i<mesh_indices.size(); i++) {
+            if (r_mesh_indices[i] < vertex_count) topology_changed = true;
         }
     }
-}
 
-void FlashPlayer::ensure_clipping_data_valid() {
-    if (!clipping_texture.is_valid()) {
-        //print_line(String("Reinitializing clipping_texture"));
-        clipping_texture.instantiate();
+    if (topology_changed) {
+        // grow capacity geometrically, unused vertices are padded with
+        // degenerate quads so the index buffer stays valid for smaller frames
+        mesh_vertex_capacity = MAX(64, (int)next_power_of_2(vertex_count));
+        Vector<Vector2> mesh_points = points;
+        Vector<Vector2> mesh_uvs = uvs;
+        Vector<Color> mesh_colors = colors;
+        mesh_points.resize(mesh_vertex_capacity);
+        mesh_uvs.resize(mesh_vertex_capacity);
+        mesh_colors.resize(mesh_vertex_capacity);
+        mesh_indices = indices;
+        mesh_indices.resize(index_count);
+        for (int i=vertex_count; i<mesh_vertex_capacity; i++) {
+            mesh_points.set(i, Vector2());
+            mesh_uvs.set(i, Vector2());
+            mesh_colors.set(i, Color(0, 0, 0, 0));
+        }
+        for (int v=vertex_count; v+3<mesh_vertex_capacity; v+=4) {
+            mesh_indices.push_back(v);
+            mesh_indices.push_back(v+1);
+            mesh_indices.push_back(v+2);
+            mesh_indices.push_back(v+2);
+            mesh_indices.push_back(v+3);
+            mesh_indices.push_back(v);
+        }
+
+        Array arrays;
+        arrays.resize(Mesh::ARRAY_MAX);
+        arrays[Mesh::ARRAY_VERTEX] = mesh_points;
+        arrays[Mesh::ARRAY_INDEX] = mesh_indices;
+        arrays[Mesh::ARRAY_COLOR] = mesh_colors;
+        arrays[Mesh::ARRAY_TEX_UV] = mesh_uvs;
+        RS::SurfaceData surface;
+        uint32_t skin_stride;
+        rs->mesh_clear(mesh);
+        rs->mesh_create_surface_data_from_arrays(
+            &surface,
+            RS::PRIMITIVE_TRIANGLES,
+            arrays, Array(), Dictionary(),
+            RS::ARRAY_FLAG_USE_2D_VERTICES | RS::ARRAY_FLAG_USE_DYNAMIC_UPDATE
+        );
+        rs->mesh_add_surface(mesh, surface);
+        rs->mesh_surface_make_offsets_from_format(
+            surface.format, surface.vertex_count, surface.index_count,
+            mesh_surface_offsets, mesh_vertex_stride, mesh_normal_tangent_stride, mesh_attribute_stride, skin_stride
+        );
+        mesh_vertex_buffer = surface.vertex_data;
+        mesh_attribute_buffer = surface.attribute_data;
+        FlashPerformance::add(FlashPerformance::BYTES_UPLOADED, surface.vertex_data.size() + surface.attribute_data.size() + surface.index_data.size());
+    } else {
+        uint8_t *vertex_write_buffer = mesh_vertex_buffer.ptrw();
+        uint8_t *attribute_write_buffer = mesh_attribute_buffer.ptrw();
+        const Vector2 *r_points = points.ptr();
+        const Vector2 *r_uvs = uvs.ptr();
+        const Color *r_colors = colors.ptr();
+        for (int i=0; i<vertex_count; i++) {
+            float vertex[2] = { (float)r_points[i].x, (float)r_points[i].y };
+            float uv[2] = { (float)r_uvs[i].x, (float)r_uvs[i].y };
+            uint8_t color[4] = {
+                uint8_t(CLAMP(r_colors[i].r * 255.0, 0.0, 255.0)),
+                uint8_t(CLAMP(r_colors[i].g * 255.0, 0.0, 255.0)),
+                uint8_t(CLAMP(r_colors[i].b * 255.0, 0.0, 255.0)),
+                uint8_t(CLAMP(r_colors[i].a * 255.0, 0.0, 255.0))
+            };
+            memcpy(&vertex_write_buffer[i * mesh_vertex_stride + mesh_surface_offsets[RS::ARRAY_VERTEX]], vertex, 8);
+            memcpy(&attribute_write_buffer[i * mesh_attribute_stride + mesh_surface_offsets[RS::ARRAY_COLOR]], color, 4);
+            memcpy(&attribute_write_buffer[i * mesh_attribute_stride + mesh_surface_offsets[RS::ARRAY_TEX_UV]], uv, 8);
+        }
+        // collapse vertices left over from the previous frame
+        float zero[2] = { 0.0, 0.0 };
+        for (int i=vertex_count; i<mesh_vertex_count; i++) {
+            memcpy(&vertex_write_buffer[i * mesh_vertex_stride + mesh_surface_offsets[RS::ARRAY_VERTEX]], zero, 8);
+        }
+        rs->mesh_surface_update_vertex_region(mesh, 0, 0, mesh_vertex_buffer);
+        rs->mesh_surface_update_attribute_region(mesh, 0, 0, mesh_attribute_buffer);
+        FlashPerformance::add(FlashPerformance::BYTES_UPLOADED, mesh_vertex_buffer.size() + mesh_attribute_buffer.size());
     }
+    FlashPerformance::add(FlashPerformance::MESH_UPLOADS, 1);
+    mesh_vertex_count = vertex_count;
 
-    if (!clipping_data.is_valid() || clipping_data->is_empty()) {
-        //print_line(String("Reinitializing clipping_data..."));
-        clipping_data.instantiate();
-        clipping_data->initialize_data(32, 32, false, Image::FORMAT_RGBA8);
-        if (clipping_data->is_empty()) {
-            print_line(String("ERROR: Failed to reinitialize clipping_data"));
-            return;
+    Rect2 bounds;
+    for (int i=0; i<vertex_count; i++) {
+        if (i == 0) {
+            bounds.position = points[i];
+        } else {
+            bounds.expand_to(points[i]);
         }
-        
-        if (clipping_texture.is_valid()) {
-            clipping_texture->create_from_image(clipping_data);
+    }
+    rs->mesh_set_custom_aabb(mesh, AABB(Vector3(bounds.position.x, bounds.position.y, 0), Vector3(bounds.size.x, bounds.size.y, 0)));
+}
+
+void FlashPlayer::queue_animation_event(const String &p_event, bool p_reversed) {
+    if (events.find(p_event) == NULL) {
+        if (p_reversed) {
+            events.push_front(p_event);
         } else {
-            print_line(String("ERROR: clipping_texture is invalid, cannot create texture"));
+            events.push_back(p_event);
         }
     }
 }
 
 void FlashPlayer::update_clipping_data() {
-    // 确保clipping_data有效
-    ensure_clipping_data_valid();
-    
-    Vector2i pos = Vector2i(0, 0);
-    Transform2D scale_transform;
-    //scale_transform.scale(Vector2(2.0, 2.0));
-
-    Transform2D glob = get_viewport_transform() * get_global_transform_with_canvas();
+    if (!clipping_dirty && clipping_texture.is_valid()) return;
+    clipping_dirty = false;
+
+    // one row per mask item: inverse transform basis, origin + atlas layer, atlas region.
+    // transforms are in node space, so the texture changes only with mask data.
+    // rows are local to the player, mesh uvs address them from 0
+    int rows = MAX(1, (int)next_power_of_2(clipping_cache.size()));
+    Vector<uint8_t> data;
+    data.resize(rows * CLIPPING_ITEM_TEXELS * 4 * sizeof(float));
+    memset(data.ptrw(), 0, data.size());
+    float *w = (float *)data.ptrw();
     for (List<FlashMaskItem>::Element *E = clipping_cache.front(); E; E = E->next()) {
-        FlashMaskItem item = E->get();
-        Transform2D tr = (glob * item.transform * scale).affine_inverse();
-        Color xy = Color(tr[0].x, tr[0].y, tr[1].x, tr[1].y);
-        Color origin = Color(tr[2].x, tr[2].y, item.texture_idx, 0);
-        Color region = Color(
-            item.texture_region.position.x,
-            item.texture_region.position.y,
-            item.texture_region.size.width,
-            item.texture_region.size.height
-        );
-        clipping_data->set_pixel(pos.x, pos.y, xy);
-        clipping_data->set_pixel(pos.x+1, pos.y, origin);
-        clipping_data->set_pixel(pos.x+2, pos.y, region);
-        pos.x += 4;
-        if (pos.x >= 32) {
-            pos.x = 0;
-            pos.y += 1;
-            if (pos.y >= 32) break;
-        }
+        const FlashMaskItem &item = E->get();
+        Transform2D tr = (item.transform * scale).affine_inverse();
+        w[0] = tr[0].x;
+        w[1] = tr[0].y;
+        w[2] = tr[1].x;
+        w[3] = tr[1].y;
+        w[4] = tr[2].x;
+        w[5] = tr[2].y;
+        w[6] = item.texture_idx;
+        w[7] = 0.0;
+        w[8] = item.texture_region.position.x;
+        w[9] = item.texture_region.position.y;
+        w[10] = item.texture_region.size.width;
+        w[11] = item.texture_region.size.height;
+        w += CLIPPING_ITEM_TEXELS * 4;
     }
-    
-    // 检查图像数据是否有效，避免设置无效图像
-    if (clipping_data.is_valid() && !clipping_data->is_empty()) {
-        clipping_texture->set_image(clipping_data);
+
+    if (clipping_texture.is_valid() && clipping_data.size() == data.size() && memcmp(clipping_data.ptr(), data.ptr(), data.size()) == 0) return;
+    clipping_data = data;
+    Ref<Image> image = Image::create_from_data(CLIPPING_ITEM_TEXELS, rows, false, Image::FORMAT_RGBAF, data);
+    FlashPerformance::add(FlashPerformance::BYTES_UPLOADED, data.size());
+    if (clipping_texture.is_null()) {
+        clipping_texture = ImageTexture::create_from_image(image);
+    } else if (clipping_texture->get_height() == rows) {
+        clipping_texture->update(image);
+    } else {
+        clipping_texture->set_image(image);
     }
 }
 
@@ -913,7 +1396,6 @@ void FlashPlayer::clip_end(int mask_id) {
 
 FlashPlayer::~FlashPlayer() {
     RS *vs = RS::get_singleton();
-    vs->free(flash_material);
     vs->free(mesh);
 }
 
@@ -929,29 +1411,58 @@ FlashPlayer::FlashPlayer() {
     loop = false;
     tracks_dirty = true;
     animation_process_queued = false;
+    offscreen_process_mode = OFFSCREEN_PROCESS_ADVANCE;
+    culled = false;
+    lod_enabled = true;
+    lod_update_interval = 1;
+    lod_max_fps = 0.0;
+    lod_screen_size = 0.0;
+    lod_skipped_time = 0.0;
+    // spreads players with the same interval over different ticks
+    lod_skipped_frames = (uint64_t)get_instance_id() % 8;
+    screen_size = -1.0;
 
     processed_frame = -1;
     current_mask = 0;
     cliping_depth = 0;
 
+    active_clips_count = 0;
+    use_baked_frames = false;
+    layer_cache_active = false;
+    layer_cache_depth = 0;
+    layer_cache_front = 0;
+    clipping_dirty = true;
+    vertex_count = 0;
+    index_count = 0;
+    mesh_dirty = true;
+    mesh_vertex_capacity = 0;
+    mesh_vertex_count = 0;
+    mesh_vertex_stride = 0;
+    mesh_normal_tangent_stride = 0;
+    mesh_attribute_stride = 0;
+    memset(mesh_surface_offsets, 0, sizeof(mesh_surface_offsets));
+
     performance_triangles_generated = 0;
     performance_triangles_drawn = 0;
 
-    RS *vs = RS::get_singleton();
-    flash_material = vs->material_create();
-    mesh = vs->mesh_create();
+    mesh = RS::get_singleton()->mesh_create();
+}
+
+RID FlashPlayer::get_flash_shader() {
     if (flash_shader == RID()) {
-        flash_shader = vs->shader_create();
-        vs->shader_set_code(flash_shader,
+        flash_shader = RS::get_singleton()->shader_create();
+        RS::get_singleton()->shader_set_code(flash_shader,
             "shader_type canvas_item;\n"
 
             "uniform sampler2DArray ATLAS;\n"
-            "uniform sampler2D CLIPPING_TEXTURE;\n"
             "uniform vec2 ATLAS_SIZE;\n"
-            "varying float CLIPPING_SIZE;\n"
-            "varying float CLIPPING_IDX[4];"
-            "varying vec4 CLIPPING_UV[4];\n"
+            "varying flat int CLIPPING_ID;\n"
+            "varying flat int CLIPPING_SIZE;\n"
+            "varying vec2 LOCAL_VERTEX;\n"
+            // clipping rows of the player are bound as the item TEXTURE
             "varying float TEX_IDX;\n"
+            // COLOR in fragment() is multiplied by TEXTURE, so the encoded color transform is passed on its own
+            "varying vec4 COLOR_TRANSFORM;\n"
 
             "void vertex() {\n"
             "   float clipping_size_with_tex_idx = 0.0;\n"
@@ -959,38 +1470,24 @@ FlashPlayer::FlashPlayer() {
             "   UV.x = 2.0 * modf(UV.x, clipping_id);\n"
             "   UV.y = 2.0 * modf(UV.y, clipping_size_with_tex_idx);\n"
             "   TEX_IDX = float(int(clipping_size_with_tex_idx) & 255);\n"
-            "   float clipping_size = float(int(clipping_size_with_tex_idx) >> 8);\n"
-            "   CLIPPING_SIZE = min(clipping_size, 4.0);\n"
-            "   for (int i=0; i<int(CLIPPING_SIZE); i++) {"
-            "       int dcx = int(clipping_id*4.0) % 32;\n"
-            "       int dcy = int(clipping_id*4.0) / 32;\n"
-            "       vec4 tr_xy = texelFetch(CLIPPING_TEXTURE, ivec2(dcx, dcy), 0);\n"
-            "       vec4 tr_origin = texelFetch(CLIPPING_TEXTURE, ivec2(dcx+1, dcy), 0);\n"
-            "       vec4 tex_region = texelFetch(CLIPPING_TEXTURE, ivec2(dcx+2, dcy), 0);\n"
-            "       vec2 tex_pos = tex_region.xy;\n"
-            "       vec2 tex_size = tex_region.zw;\n"
-
-            "       mat4 tr = mat4(\n"
-            "           vec4(tr_xy.r, tr_xy.g, 0.0, 0.0),\n"
-            "           vec4(tr_xy.b, tr_xy.a, 0.0, 0.0),\n"
-            "           vec4(0.0, 0.0, 1.0, 0.0),\n"
-            "           vec4(tr_origin.r, tr_origin.g, 0.0, 1.0)\n"
-            "       );\n"
-            // "       mat4 local = tr * WORLD_MATRIX * EXTRA_MATRIX;\n"
-            "       mat4 local = tr * CANVAS_MATRIX;\n"
-            "       vec2 clipping_pos = (local * vec4(VERTEX, 0.0 ,1.0)).xy;\n"
-            "       CLIPPING_UV[i].xy = clipping_pos / tex_size;\n"
-            "       CLIPPING_UV[i].zw = (clipping_pos + tex_pos)/ATLAS_SIZE;\n"
-            "       CLIPPING_IDX[i] = tr_origin.b;\n"
-            "   }\n"
+            "   CLIPPING_ID = int(clipping_id);\n"
+            "   CLIPPING_SIZE = int(clipping_size_with_tex_idx) >> 8;\n"
+            "   LOCAL_VERTEX = VERTEX;\n"
+            "   COLOR_TRANSFORM = COLOR;\n"
             "}\n"
 
             "void fragment() {\n"
             "   float masked = 1.0;\n"
-            "   if (int(CLIPPING_SIZE) > 0) masked = 0.0;\n"
-            "   for (int i=0; i<int(CLIPPING_SIZE); i++) {\n"
-            "       if (CLIPPING_UV[i].x >= 0.0 && CLIPPING_UV[i].x < 1.0 && CLIPPING_UV[i].y >= 0.0 && CLIPPING_UV[i].y < 1.0) {\n"
-            "           vec4 mask = textureLod(ATLAS, vec3(CLIPPING_UV[i].zw, CLIPPING_IDX[i]), 0.0);\n"
+            "   if (CLIPPING_SIZE > 0) masked = 0.0;\n"
+            "   for (int i=0; i<CLIPPING_SIZE; i++) {\n"
+            "       int row = CLIPPING_ID + i;\n"
+            "       vec4 tr_xy = texelFetch(TEXTURE, ivec2(0, row), 0);\n"
+            "       vec4 tr_origin = texelFetch(TEXTURE, ivec2(1, row), 0);\n"
+            "       vec4 tex_region = texelFetch(TEXTURE, ivec2(2, row), 0);\n"
+            "       vec2 clipping_pos = mat2(tr_xy.xy, tr_xy.zw) * LOCAL_VERTEX + tr_origin.xy;\n"
+            "       vec2 clipping_uv = clipping_pos / tex_region.zw;\n"
+            "       if (clipping_uv.x >= 0.0 && clipping_uv.x < 1.0 && clipping_uv.y >= 0.0 && clipping_uv.y < 1.0) {\n"
+            "           vec4 mask = textureLod(ATLAS, vec3((clipping_pos + tex_region.xy)/ATLAS_SIZE, tr_origin.z), 0.0);\n"
             "           if (mask.a >= 1.0) {\n"
             "               masked = 1.0;\n"
             "               break;\n"
@@ -1001,7 +1498,7 @@ FlashPlayer::FlashPlayer() {
             "   if (masked > 0.0) {\n"
             "       vec4 add;\n"
             "       vec4 c = texture(ATLAS, vec3(UV, TEX_IDX));\n"
-            "       vec4 mult = 2.0*modf(COLOR, add);\n"
+            "       vec4 mult = 2.0*modf(COLOR_TRANSFORM, add);\n"
             "       COLOR = c * mult + add;\n"
             "       if (c.a <= 0.0) {\n"
             "           COLOR.a = 0.0;\n"
@@ -1014,6 +1511,5 @@ FlashPlayer::FlashPlayer() {
             "}\n"
         );
     }
-    vs->material_set_shader(flash_material, flash_shader);
-    vs->canvas_item_set_material(get_canvas_item(), flash_material);
-}
\ No newline at end of file
+    return flash_shader;
+}
@@ -24,21 +24,29 @@
 #define FLASH_PLAYER_H
 
 #include <scene/2d/node_2d.h>
+#include <core/templates/local_vector.h>
 
 #include "flash_resources.h"
 
 class FlashDocument;
 class FlashTimeline;
 
-struct FlashMaskItem {
-    Transform2D transform;
-    Rect2 texture_region;
-    int texture_idx;
-};
-
 class FlashPlayer: public Node2D {
     GDCLASS(FlashPlayer, Node2D);
 
+    friend class FlashBenchmark;
+
+public:
+    enum OffscreenProcessMode {
+        OFFSCREEN_PROCESS_ALWAYS,
+        OFFSCREEN_PROCESS_ADVANCE,
+        OFFSCREEN_PROCESS_PAUSE
+    };
+
+protected:
+    // texels per mask item row in the clipping texture
+    static const int CLIPPING_ITEM_TEXELS = 3;
+
     // renderer part
     float frame;
     float frame_rate;
@@ -53,9 +61,35 @@ class FlashPlayer: public Node2D {
     Ref<FlashTimeline> active_symbol;
     String active_clip;
     bool loop;
-    RID flash_material;
     RID mesh;
     static RID flash_shader;
+
+    // players hidden or outside of the viewport skip evaluation,
+    // `culled` is refreshed every process tick
+    OffscreenProcessMode offscreen_process_mode;
+    bool culled;
+
+    // level of detail, skipped ticks accumulate their delta so playback stays in sync
+    bool lod_enabled;
+    int lod_update_interval;
+    float lod_max_fps;
+    float lod_screen_size;
+    float lod_skipped_time;
+    int lod_skipped_frames;
+    // longest side of the bounds on screen, measured with culling, negative when unknown
+    float screen_size;
+
+    // persistent mesh part
+    bool mesh_dirty;
+    int mesh_vertex_capacity;
+    int mesh_vertex_count;
+    Vector<int> mesh_indices;
+    uint32_t mesh_surface_offsets[RS::ARRAY_MAX];
+    uint32_t mesh_vertex_stride;
+    uint32_t mesh_normal_tangent_stride;
+    uint32_t mesh_attribute_stride;
+    PackedByteArray mesh_vertex_buffer;
+    PackedByteArray mesh_attribute_buffer;
     Transform2D scale; // 添加scale成员变量
 
     // batcher part
@@ -65,16 +99,38 @@ class FlashPlayer: public Node2D {
     Vector<Vector2> uvs;
     Vector<Color> colors;
     Vector<int> indices;
+    int vertex_count;
+    int index_count;
     List<String> events;
-
-    HashMap<String, Vector3> clips_state;
-    HashMap<String, String> active_clips;
-    Ref<Image> clipping_data;
+    bool use_baked_frames;
+
+    // incremental part: layers with static content copy their
+    // previous frame range from the back geometry buffers
+    bool layer_cache_active;
+    int layer_cache_depth;
+    int layer_cache_front;
+    LocalVector<FlashLayerCacheEntry> layer_cache[2];
+    Vector<Vector2> prev_points;
+    Vector<Vector2> prev_uvs;
+    Vector<Color> prev_colors;
+    Vector<int> prev_indices;
+
+    // indexed by document clip track: start, end, elapsed and active clip id (-1 for default)
+    Vector<Vector3> clips_state;
+    Vector<int> active_clips;
+    int active_clips_count;
+    // mask rows of the player, bound as the item texture so the material stays shared
+    Vector<uint8_t> clipping_data;
     Ref<ImageTexture> clipping_texture;
+    bool clipping_dirty;
     HashMap<int, List<FlashMaskItem>> masks;
     List<int> mask_stack;
     Vector<int> frame_overrides;
-    HashMap<String, String> active_variants;
+    // indexed by document variant slot, active option id (-1 for default)
+    Vector<int> active_variants;
+    // set before the resource, applied once it is
+    HashMap<String, Variant> pending_variants;
+    HashMap<String, Variant> pending_clips;
     List<FlashMaskItem> clipping_cache;
     List<FlashMaskItem> clipping_items;
     int current_mask;
@@ -90,19 +146,33 @@ protected:
 	void _get_property_list(List<PropertyInfo> *p_list) const;
     virtual void _validate_property(PropertyInfo &prop) const;
 	static void _bind_methods();
+    FlashBakedFrame evaluate_frame(int p_frame);
     bool _sort_clips(Variant a, Variant b) const;
+    void activate_clip(int p_track, int p_clip);
+    void _update_culled();
+    bool _lod_step(float &r_delta);
+    void _emit_animation_events();
 
 public:
     FlashPlayer();
     ~FlashPlayer();
 
+    static RID get_flash_shader();
+
     float get_frame() const { return frame; }
     void set_frame(float p_frame) { frame = p_frame; queue_redraw(); }
     void override_frame(String p_symbol, Variant p_frame);
     void set_variant(String key, Variant value);
     String get_variant(String key) const;
+    void set_variant_by_id(int p_slot, int p_option);
+    int find_variant_slot(const String &p_variant) const;
+    int find_variant_option(int p_slot, const String &p_option) const;
     void set_clip(String header, Variant value);
     String get_clip(String header) const;
+    void set_clip_by_id(int p_track, int p_clip);
+    int get_clip_id(int p_track) const;
+    int find_clip_track(const String &p_track) const;
+    int find_clip(int p_track, const String &p_clip) const;
     PackedStringArray get_clips_tracks() const;
     PackedStringArray get_clips_for_track(const String &track) const;
     float get_clip_duration(const String &track, const String &clip) const;
@@ -114,6 +184,19 @@ public:
     void set_playing(bool p_playing) { playing = p_playing; }
     bool is_loop() const { return loop; }
     void set_loop(bool p_loop) { loop = p_loop; }
+    OffscreenProcessMode get_offscreen_process_mode() const { return offscreen_process_mode; }
+    void set_offscreen_process_mode(OffscreenProcessMode p_mode);
+    bool is_culled() const { return culled; }
+    bool is_lod_enabled() const { return lod_enabled; }
+    void set_lod_enabled(bool p_enabled) { lod_enabled = p_enabled; }
+    int get_lod_update_interval() const { return lod_update_interval; }
+    void set_lod_update_interval(int p_interval) { lod_update_interval = MAX(p_interval, 1); }
+    float get_lod_max_fps() const { return lod_max_fps; }
+    void set_lod_max_fps(float p_max_fps) { lod_max_fps = MAX(p_max_fps, 0.0f); }
+    float get_lod_screen_size() const { return lod_screen_size; }
+    void set_lod_screen_size(float p_screen_size) { lod_screen_size = MAX(p_screen_size, 0.0f); }
+    virtual bool get_local_bounds(Rect2 &r_bounds);
+    Rect2 get_bounds();
     Ref<FlashDocument> get_resource() const;
     void set_resource(const Ref<FlashDocument> &doc);
     float get_duration(String symbol=String(), String label=String());
@@ -128,11 +211,25 @@ public:
     void queue_animation_process();
     void queue_process(float delta=0.0);
     void _animation_process();
+    bool _animation_begin();
+    virtual void _animation_evaluate();
+    void _animation_end();
     void advance(float p_delta, bool p_skip=false, bool advance_all_tracks=false);
     void advance_clip_for_track(const String &p_track, const String &p_clip, float delta=0.0, bool p_skip=false, float *r_elapsed=NULL, float *r_ramaining=NULL);
+    void advance_clip_by_id(int p_track, int p_clip, float delta=0.0, bool p_skip=false, float *r_elapsed=NULL, float *r_ramaining=NULL);
+    bool can_use_baked_frames() const;
+    FlashBakedFrame get_baked_frame(int p_frame);
+    void bake();
+    void update_mesh();
     void update_clipping_data();
-    void ensure_clipping_data_valid();
-    void add_polygon(Vector<Vector2> p_points, Vector<Color> p_colors, Vector<Vector2> p_uvs, int p_texture_idx);
+    void clear_geometry();
+    void reserve_geometry(int p_vertices, int p_indices);
+    void clear_layer_cache();
+    bool layer_cache_begin(FlashLayerCacheEntry &p_entry, int &r_slot);
+    void layer_cache_end(int p_slot);
+    void add_quad(const Vector2 *p_points, const Color &p_color, const Rect2 &p_uv_rect, int p_texture_idx);
+    void add_convex_polygon(const Vector2 *p_points, const Vector2 *p_uvs, int p_count, const Color &p_color, int p_texture_idx);
+    void add_polygon(const Vector<Vector2> &p_points, const Vector<Color> &p_colors, const Vector<Vector2> &p_uvs, int p_texture_idx);
     void queue_animation_event(const String &p_name, bool p_reversed=false);
 
     bool is_masking();
@@ -144,5 +241,6 @@ public:
     void clip_end(int layer);
 };
 
+VARIANT_ENUM_CAST(FlashPlayer::OffscreenProcessMode);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,129 @@
+// MIT License
+
+// Copyright (c) 2021 Yakov Borevich, Funexpected LLC
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "flash_player_server.h"
+#include "flash_player.h"
+#include "flash_performance.h"
+#include "flash_resources.h"
+
+#include <core/object/worker_thread_pool.h>
+#include <core/os/os.h>
+
+FlashPlayerServer *FlashPlayerServer::singleton = nullptr;
+
+void FlashPlayerServer::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("flush"), &FlashPlayerServer::flush);
+    ClassDB::bind_method(D_METHOD("set_use_threads", "use_threads"), &FlashPlayerServer::set_use_threads);
+    ClassDB::bind_method(D_METHOD("is_using_threads"), &FlashPlayerServer::is_using_threads);
+    ClassDB::bind_method(D_METHOD("set_min_batch_size", "min_batch_size"), &FlashPlayerServer::set_min_batch_size);
+    ClassDB::bind_method(D_METHOD("get_min_batch_size"), &FlashPlayerServer::get_min_batch_size);
+
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "use_threads"), "set_use_threads", "is_using_threads");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "min_batch_size"), "set_min_batch_size", "get_min_batch_size");
+}
+
+void FlashPlayerServer::queue_player(FlashPlayer *p_player) {
+    queued_players.push_back(p_player->get_instance_id());
+    if (!flush_queued) {
+        flush_queued = true;
+        call_deferred("flush");
+    }
+}
+
+void FlashPlayerServer::queue_eviction(FlashDocument *p_document) {
+    ObjectID id = p_document->get_instance_id();
+    for (uint32_t i=0; i<evicting_documents.size(); i++) {
+        if (evicting_documents[i] == id) return;
+    }
+    evicting_documents.push_back(id);
+    if (!flush_queued) {
+        flush_queued = true;
+        call_deferred("flush");
+    }
+}
+
+void FlashPlayerServer::_evict_symbols() {
+    // runs once workers are joined, no player is evaluating symbols meanwhile
+    for (uint32_t i=0; i<evicting_documents.size(); i++) {
+        FlashDocument *document = Object::cast_to<FlashDocument>(ObjectDB::get_instance(evicting_documents[i]));
+        if (document == nullptr) continue;
+        document->evict_unused_symbols();
+    }
+    evicting_documents.clear();
+}
+
+void FlashPlayerServer::_evaluate_player(uint32_t p_index, FlashPlayer **p_players) {
+    // summed over workers, so it is cpu time rather than wall time
+    uint64_t start = OS::get_singleton()->get_ticks_usec();
+    p_players[p_index]->_animation_evaluate();
+    FlashPerformance::add(FlashPerformance::PROCESS_USEC, OS::get_singleton()->get_ticks_usec() - start);
+}
+
+void FlashPlayerServer::flush() {
+    flush_queued = false;
+    if (queued_players.size() == 0) {
+        _evict_symbols();
+        return;
+    }
+
+    // players queued from signal handlers below go to the next flush
+    LocalVector<ObjectID> players = queued_players;
+    queued_players.clear();
+
+    batch.clear();
+    for (uint32_t i=0; i<players.size(); i++) {
+        FlashPlayer *player = Object::cast_to<FlashPlayer>(ObjectDB::get_instance(players[i]));
+        if (player == nullptr) continue;
+        if (player->_animation_begin()) {
+            batch.push_back(player);
+        }
+    }
+
+    if (use_threads && (int)batch.size() >= min_batch_size) {
+        WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_template_group_task(
+            this, &FlashPlayerServer::_evaluate_player, batch.ptr(), batch.size(), -1, true, SNAME("FlashPlayerServer")
+        );
+        WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+    } else {
+        for (uint32_t i=0; i<batch.size(); i++) {
+            _evaluate_player(i, batch.ptr());
+        }
+    }
+
+    for (uint32_t i=0; i<batch.size(); i++) {
+        batch[i]->_animation_end();
+    }
+    batch.clear();
+    _evict_symbols();
+}
+
+FlashPlayerServer::FlashPlayerServer() {
+    singleton = this;
+    flush_queued = false;
+    use_threads = true;
+    min_batch_size = 4;
+}
+
+FlashPlayerServer::~FlashPlayerServer() {
+    if (singleton == this) singleton = nullptr;
+}
@@ -0,0 +1,70 @@
+// MIT License
+
+// Copyright (c) 2021 Yakov Borevich, Funexpected LLC
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FLASH_PLAYER_SERVER_H
+#define FLASH_PLAYER_SERVER_H
+
+#include <core/object/object.h>
+#include <core/templates/local_vector.h>
+
+class FlashPlayer;
+class FlashDocument;
+
+// Gathers players queued for animation processing during the frame and
+// evaluates them in one deferred batch. Timelines are evaluated on the
+// WorkerThreadPool, mesh uploads and signals stay on the main thread.
+// Symbols are evicted after the batch, once no worker evaluates them.
+class FlashPlayerServer: public Object {
+    GDCLASS(FlashPlayerServer, Object);
+
+    static FlashPlayerServer *singleton;
+
+    LocalVector<ObjectID> queued_players;
+    LocalVector<FlashPlayer*> batch;
+    LocalVector<ObjectID> evicting_documents;
+    bool flush_queued;
+    bool use_threads;
+    int min_batch_size;
+
+    void _evaluate_player(uint32_t p_index, FlashPlayer **p_players);
+    void _evict_symbols();
+
+protected:
+    static void _bind_methods();
+
+public:
+    static FlashPlayerServer *get_singleton() { return singleton; }
+
+    void queue_player(FlashPlayer *p_player);
+    void queue_eviction(FlashDocument *p_document);
+    void flush();
+
+    bool is_using_threads() const { return use_threads; }
+    void set_use_threads(bool p_use_threads) { use_threads = p_use_threads; }
+    int get_min_batch_size() const { return min_batch_size; }
+    void set_min_batch_size(int p_min_batch_size) { min_batch_size = MAX(p_min_batch_size, 1); }
+
+    FlashPlayerServer();
+    ~FlashPlayerServer();
+};
+
+#endif
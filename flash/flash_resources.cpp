@@ -23,6 +23,8 @@
 #include "flash_resources.h"
 #include "core/io/compression.h"
 #include "core/io/marshalls.h"
+#include "core/object/worker_thread_pool.h"
+#include "core/config/engine.h"
 
 FlashDocument *FlashElement::get_document() const {
     return document;
@@ -149,6 +151,8 @@ Error FlashElement::parse(Ref<XMLParser> xml) {
 }
 void FlashDocument::_bind_methods() {
     ClassDB::bind_method(D_METHOD("load_file", "path"), &FlashDocument::load_file);
+    ClassDB::bind_method(D_METHOD("load_binary", "path"), &FlashDocument::load_binary);
+    ClassDB::bind_method(D_METHOD("save_binary", "path"), &FlashDocument::save_binary);
     ClassDB::bind_method(D_METHOD("get_atlas"), &FlashDocument::get_atlas);
     ClassDB::bind_method(D_METHOD("set_atlas", "atlas"), &FlashDocument::set_atlas);
     ClassDB::bind_method(D_METHOD("get_symbols"), &FlashDocument::get_symbols);
@@ -159,7 +163,23 @@ void FlashDocument::_bind_methods() {
     ClassDB::bind_method(D_METHOD("set_timelines", "timelines"), &FlashDocument::set_timelines);
     ClassDB::bind_method(D_METHOD("get_duration"), &FlashDocument::get_duration, DEFVAL(String()), DEFVAL(String()));
     ClassDB::bind_method(D_METHOD("get_variants"), &FlashDocument::get_variants);
-
+    ClassDB::bind_method(D_METHOD("set_bake_frames", "bake_frames"), &FlashDocument::set_bake_frames);
+    ClassDB::bind_method(D_METHOD("is_bake_frames"), &FlashDocument::is_bake_frames);
+    ClassDB::bind_method(D_METHOD("set_bake_interpolation", "bake_interpolation"), &FlashDocument::set_bake_interpolation);
+    ClassDB::bind_method(D_METHOD("is_bake_interpolation"), &FlashDocument::is_bake_interpolation);
+    ClassDB::bind_method(D_METHOD("clear_baked_frames"), &FlashDocument::clear_baked_frames);
+    ClassDB::bind_method(D_METHOD("set_lazy_symbols", "lazy_symbols"), &FlashDocument::set_lazy_symbols);
+    ClassDB::bind_method(D_METHOD("is_lazy_symbols"), &FlashDocument::is_lazy_symbols);
+    ClassDB::bind_method(D_METHOD("evict_symbol", "token"), &FlashDocument::evict_symbol_by_token);
+    ClassDB::bind_method(D_METHOD("evict_unused_symbols", "frames"), &FlashDocument::evict_unused_symbols, DEFVAL(1));
+    ClassDB::bind_method(D_METHOD("get_loaded_symbols_count"), &FlashDocument::get_loaded_symbols_count);
+    ClassDB::bind_method(D_METHOD("prefetch_symbols", "tokens"), &FlashDocument::prefetch_symbols);
+    ClassDB::bind_method(D_METHOD("is_prefetching"), &FlashDocument::is_prefetching);
+    ClassDB::bind_method(D_METHOD("wait_for_prefetch"), &FlashDocument::wait_for_prefetch);
+
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "bake_frames"), "set_bake_frames", "is_bake_frames");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "bake_interpolation"), "set_bake_interpolation", "is_bake_interpolation");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "lazy_symbols"), "set_lazy_symbols", "is_lazy_symbols");
     ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "atlas", PROPERTY_HINT_RESOURCE_TYPE, "TextureArray", PROPERTY_USAGE_NO_EDITOR | PROPERTY_USAGE_INTERNAL), "set_atlas", "get_atlas");
     ADD_PROPERTY(PropertyInfo(Variant::DICTIONARY, "symbols", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NO_EDITOR | PROPERTY_USAGE_INTERNAL), "set_symbols", "get_symbols");
     ADD_PROPERTY(PropertyInfo(Variant::DICTIONARY, "bitmaps", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NO_EDITOR | PROPERTY_USAGE_INTERNAL), "set_bitmaps", "get_bitmaps");
@@ -167,7 +187,8 @@ void FlashDocument::_bind_methods() {
 }
 template <class T> Ref<T> FlashDocument::element(FlashElement *parent) {
     Ref<T> elem; elem.instantiate();
-    elem->set_eid(last_eid++);
+    // symbols parsed concurrently are renumbered once they are joined
+    elem->set_eid(last_eid.postincrement());
     elem->set_parent(parent);
     elem->set_document(this);
     return elem;
@@ -223,10 +244,32 @@ float FlashDocument::get_duration(String timeline, String label) {
 Dictionary FlashDocument::get_variants() const {
     return variants;
 }
+void FlashDocument::set_bake_frames(bool p_bake_frames) {
+    if (bake_frames == p_bake_frames) return;
+    bake_frames = p_bake_frames;
+    if (!bake_frames) clear_baked_frames();
+}
+void FlashDocument::clear_baked_frames() {
+    Array symbols_array = symbols.values();
+    for (int i=0; i<symbols_array.size(); i++) {
+        Ref<FlashTimeline> timeline = symbols_array[i];
+        if (timeline.is_valid()) timeline->clear_baked_frames();
+    }
+    for (List<Ref<FlashTimeline>>::Element *E = timelines.front(); E; E = E->next()) {
+        E->get()->clear_baked_frames();
+    }
+}
 void FlashDocument::cache_variants() {
+    // rebuilt from scratch, setup runs again after symbols change
+    variants.clear();
+    variant_slots.clear();
+    variant_slot_ids.clear();
+    variated_symbols_count = 0;
     HashSet<String> variated_symbols;
     for (int i=0; i<symbols.size(); i++) {
         Ref<FlashTimeline> timeline = symbols.get_value_at_index(i);
+        if (timeline.is_null()) continue;
+        timeline->set_variation_idx(-1);
         String token = timeline->get_token();
         for (List<Ref<FlashLayer>>::Element *L = timeline->layers.front(); L; L = L->next()) {
             Ref<FlashLayer> layer = L->get();
@@ -262,6 +305,81 @@ void FlashDocument::cache_variants() {
         variant_idx++; 
         ++E;
     }
+
+    for (int i=0; i<variants.size(); i++) {
+        FlashVariantSlot slot;
+        slot.name = variants.get_key_at_index(i);
+        Dictionary symbols_by_variant = variants.get_value_at_index(i);
+        for (int j=0; j<symbols_by_variant.size(); j++) {
+            String option = symbols_by_variant.get_key_at_index(j);
+            Dictionary frames_by_symbol = symbols_by_variant.get_value_at_index(j);
+            Vector<Vector2i> overrides;
+            for (int k=0; k<frames_by_symbol.size(); k++) {
+                Ref<FlashTimeline> symbol = symbols.get(frames_by_symbol.get_key_at_index(k), Variant());
+                if (symbol.is_null() || symbol->get_variation_idx() < 0) continue;
+                overrides.push_back(Vector2i(symbol->get_variation_idx(), (int)frames_by_symbol.get_value_at_index(k)));
+            }
+            slot.option_ids[option] = slot.options.size();
+            slot.options.push_back(option);
+            slot.overrides.push_back(overrides);
+        }
+        variant_slot_ids[slot.name] = variant_slots.size();
+        variant_slots.push_back(slot);
+    }
+}
+void FlashDocument::cache_clips() {
+    clip_tracks.clear();
+    clip_track_ids.clear();
+    for (int i=0; i<symbols.size(); i++) {
+        Ref<FlashTimeline> timeline = symbols.get_value_at_index(i);
+        if (timeline.is_null()) continue;
+        timeline->clip_track_idx = -1;
+        String header = timeline->get_clips_header();
+        if (header == String()) continue;
+        const int *track_id = clip_track_ids.getptr(header);
+        if (track_id == nullptr) {
+            FlashClipTrack track;
+            track.name = header;
+            clip_track_ids[header] = clip_tracks.size();
+            clip_tracks.push_back(track);
+            track_id = clip_track_ids.getptr(header);
+        }
+        timeline->clip_track_idx = *track_id;
+        FlashClipTrack &track = clip_tracks.write[*track_id];
+        Dictionary clips = timeline->get_clips();
+        for (int j=0; j<clips.size(); j++) {
+            String clip = clips.get_key_at_index(j);
+            if (track.clip_ids.has(clip)) continue;
+            track.clip_ids[clip] = track.clips.size();
+            track.clips.push_back(clip);
+            track.ranges.push_back((Vector2)clips.get_value_at_index(j));
+        }
+    }
+}
+int FlashDocument::find_clip_track(const String &p_track) const {
+    const int *track_id = clip_track_ids.getptr(p_track);
+    return track_id != nullptr ? *track_id : -1;
+}
+int FlashDocument::find_clip(int p_track, const String &p_clip) const {
+    ERR_FAIL_INDEX_V(p_track, clip_tracks.size(), -1);
+    const int *clip_id = clip_tracks[p_track].clip_ids.getptr(p_clip);
+    return clip_id != nullptr ? *clip_id : -1;
+}
+int FlashDocument::find_variant_slot(const String &p_variant) const {
+    const int *slot_id = variant_slot_ids.getptr(p_variant);
+    return slot_id != nullptr ? *slot_id : -1;
+}
+void FlashDocument::cache_static() {
+    // lazy documents compute the flags on first use, doing it here
+    // would load every symbol nested into the main timelines
+    if (lazy_symbols) return;
+    for (int i=0; i<symbols.size(); i++) {
+        Ref<FlashTimeline> timeline = symbols.get_value_at_index(i);
+        if (timeline.is_valid()) timeline->cache_static();
+    }
+    for (List<Ref<FlashTimeline>>::Element *E = timelines.front(); E; E = E->next()) {
+        E->get()->cache_static();
+    }
 }
 Ref<FlashDocument> FlashDocument::from_file(const String &p_path) {
     Ref<FlashDocument> doc; doc.instantiate();
@@ -272,10 +390,63 @@ Ref<FlashDocument> FlashDocument::from_file(const String &p_path) {
 Vector2 FlashDocument::get_atlas_size() const {
     return atlas.is_valid() ? Vector2(atlas->get_width(), atlas->get_height()) : Vector2();
 }
+void FlashDocument::set_atlas(Ref<CompressedTexture2DArray> p_atlas) {
+    atlas = p_atlas;
+    if (material.is_valid()) {
+        RS::get_singleton()->material_set_param(material, "ATLAS_SIZE", get_atlas_size());
+        RS::get_singleton()->material_set_param(material, "ATLAS", atlas.is_valid() ? atlas->get_rid() : RID());
+    }
+}
+RID FlashDocument::get_material() {
+    // one material per document (and so per atlas), shared by all its players
+    if (!material.is_valid()) {
+        material = RS::get_singleton()->material_create();
+        RS::get_singleton()->material_set_shader(material, FlashPlayer::get_flash_shader());
+        RS::get_singleton()->material_set_param(material, "ATLAS_SIZE", get_atlas_size());
+        RS::get_singleton()->material_set_param(material, "ATLAS", atlas.is_valid() ? atlas->get_rid() : RID());
+    }
+    return material;
+}
+FlashDocument::~FlashDocument() {
+    _collect_prefetch_tasks(true);
+    if (material.is_valid()) {
+        RS::get_singleton()->free(material);
+    }
+}
+
+Error FlashDocument::open_xml(Ref<XMLParser> p_xml, const String &p_path) const {
+    if (source_files != nullptr) {
+        const Vector<uint8_t> *data = source_files->getptr(p_path);
+        if (data == nullptr) return ERR_FILE_NOT_FOUND;
+        return p_xml->open_buffer(*data);
+    }
+    return p_xml->open(p_path);
+}
+
+Error FlashDocument::load_files(const String &p_document_path, const HashMap<String, Vector<uint8_t>> &p_files) {
+    source_files = &p_files;
+    Ref<XMLParser> xml; xml.instantiate();
+    Error err = open_xml(xml, p_document_path);
+    if (err != Error::OK) {
+        source_files = nullptr;
+        ERR_FAIL_V_MSG(err, "Can't open " + p_document_path);
+    }
+    xml->set_meta("path", p_document_path);
+    parent = NULL;
+    document = this;
+    document_path = p_document_path.get_base_dir();
+    err = parse(xml);
+    if (err == Error::OK) {
+        parse_timelines();
+    }
+    source_files = nullptr;
+    ERR_FAIL_COND_V_MSG(err != Error::OK, err, "Can't parse " + p_document_path);
+    return OK;
+}
 
 Error FlashDocument::load_file(const String &p_path) {
     Ref<XMLParser> xml; xml.instantiate();
-    Error err = xml->open(p_path);
+    Error err = open_xml(xml, p_path);
     ERR_FAIL_COND_V_MSG(err != Error::OK, err, "Can't open " + p_path);
     xml->set_meta("path", p_path);
     parent = NULL;
@@ -283,6 +454,7 @@ Error FlashDocument::load_file(const String &p_path) {
     document_path = p_path.get_base_dir();
     err = parse(xml);
     ERR_FAIL_COND_V_MSG(err != Error::OK, err, "Can't parse " + p_path);
+    parse_timelines();
     
     // 如果atlas未设置，尝试从导入的资源中加载
     if (!atlas.is_valid()) {
@@ -307,24 +479,185 @@ Error FlashDocument::load_file(const String &p_path) {
     return OK;
 }
 
+FlashTimeline* FlashDocument::find_symbol(const String &p_token) const {
+    Ref<FlashTimeline> tl = symbols.get(p_token, Variant());
+    return tl.ptr();
+}
+
 FlashTimeline* FlashDocument::get_timeline(String token) {
-    Ref<FlashTimeline> tl = symbols.get(token, Variant());
-    return tl.is_valid() ? tl.ptr() : nullptr;
+    FlashTimeline *tl = find_symbol(token);
+    if (tl == nullptr) return nullptr;
+    tl->ensure_loaded();
+    return tl;
+}
+
+bool FlashDocument::evict_symbol(FlashTimeline *p_timeline) {
+    // players must not be processing this document meanwhile, nested
+    // symbols keep pointers to the timeline and reload it on next use
+    ERR_FAIL_NULL_V(p_timeline, false);
+    MutexLock lock(symbols_mutex);
+    if (binary_data.is_empty() || !p_timeline->loaded.is_set() || p_timeline->loading) return false;
+    for (int i=0; i<2; i++) {
+        List<Ref<FlashLayer>> &layers = i == 0 ? p_timeline->masks : p_timeline->layers;
+        for (List<Ref<FlashLayer>>::Element *L = layers.front(); L; L = L->next()) {
+            for (List<Ref<FlashFrame>>::Element *F = L->get()->frames.front(); F; F = F->next()) {
+                FlashFrame *frame = F->get().ptr();
+                if (frame->binary_frame < 0) continue;
+                // element records stay in memory, only what setup compiled is dropped
+                frame->tweens.clear();
+                frame->tween = nullptr;
+                frame->element_effects.clear();
+                frame->binary_refs = nullptr;
+                frame->elements_count = 0;
+            }
+        }
+    }
+    p_timeline->loaded.clear();
+    p_timeline->setup(this, this);
+    return true;
 }
 
-void FlashDocument::parse_timeline(const String &path) {
-    String symbol_path = document_path + "/LIBRARY/" + path;
+bool FlashDocument::evict_symbol_by_token(const String &p_token) {
+    Ref<FlashTimeline> tl = symbols.get(p_token, Variant());
+    return tl.is_valid() && evict_symbol(tl.ptr());
+}
+
+int FlashDocument::evict_unused_symbols(int p_frames) {
+    if (binary_data.is_empty()) return 0;
+    uint64_t current = Engine::get_singleton()->get_process_frames();
+    int evicted = 0;
+    for (int i=0; i<symbols.size(); i++) {
+        Ref<FlashTimeline> tl = symbols.get_value_at_index(i);
+        if (tl.is_null() || !tl->is_loaded()) continue;
+        if (current - tl->get_last_used() <= (uint64_t)MAX(p_frames, 0)) continue;
+        if (evict_symbol(tl.ptr())) evicted++;
+    }
+    return evicted;
+}
+
+int FlashDocument::get_loaded_symbols_count() const {
+    int count = 0;
+    for (int i=0; i<symbols.size(); i++) {
+        Ref<FlashTimeline> tl = symbols.get_value_at_index(i);
+        if (tl.is_valid() && tl->is_loaded()) count++;
+    }
+    return count;
+}
+
+void FlashDocument::_prefetch_task(PackedStringArray p_tokens) {
+    for (int i=0; i<p_tokens.size(); i++) {
+        get_timeline(p_tokens[i]);
+    }
+}
+
+void FlashDocument::_collect_prefetch_tasks(bool p_wait) {
+    for (int i=prefetch_tasks.size()-1; i>=0; i--) {
+        if (!p_wait && !WorkerThreadPool::get_singleton()->is_task_completed(prefetch_tasks[i])) continue;
+        WorkerThreadPool::get_singleton()->wait_for_task_completion(prefetch_tasks[i]);
+        prefetch_tasks.remove_at(i);
+    }
+}
+
+void FlashDocument::prefetch_symbols(const PackedStringArray &p_tokens) {
+    // loads are serialized by the symbols mutex, one task per request is enough
+    _collect_prefetch_tasks(false);
+    if (binary_data.is_empty() || p_tokens.size() == 0) return;
+    prefetch_tasks.push_back(WorkerThreadPool::get_singleton()->add_template_task(
+        this, &FlashDocument::_prefetch_task, p_tokens, false, "FlashDocumentPrefetch"
+    ));
+}
+
+bool FlashDocument::is_prefetching() {
+    _collect_prefetch_tasks(false);
+    return prefetch_tasks.size() > 0;
+}
+
+void FlashDocument::wait_for_prefetch() {
+    _collect_prefetch_tasks(true);
+}
+
+Ref<FlashTimeline> FlashDocument::parse_timeline(const String &path) {
+    String symbol_path = document_path.path_join("LIBRARY").path_join(path);
     Ref<XMLParser> xml; xml.instantiate();
-    Error err = xml->open(symbol_path);
+    Error err = open_xml(xml, symbol_path);
     Ref<FlashTimeline> timeline = element<FlashTimeline>();
     if (err != OK) {
-        return;
+        return Ref<FlashTimeline>();
     }
-    ERR_FAIL_COND_MSG(err != Error::OK, "Can't open " + symbol_path);
     xml->set_meta("path", symbol_path);
     timeline->parse(xml);
     timeline->set_local_path(path);
-    symbols[timeline->token] = timeline;
+    return timeline;
+}
+
+void FlashDocument::_parse_timeline_task(uint32_t p_index, Ref<FlashTimeline> *r_timelines) {
+    r_timelines[p_index] = parse_timeline(includes[p_index]);
+}
+
+void FlashDocument::parse_timelines() {
+    // symbols are independent of each other, parse them on all cores
+    Vector<Ref<FlashTimeline>> parsed;
+    parsed.resize(includes.size());
+    int first_eid = last_eid.get();
+    if (includes.size() > 1) {
+        WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_template_group_task(
+            this, &FlashDocument::_parse_timeline_task, parsed.ptrw(), includes.size(), -1, true, SNAME("FlashDocumentParse")
+        );
+        WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+    } else if (includes.size() == 1) {
+        parsed.write[0] = parse_timeline(includes[0]);
+    }
+    // register and number in include order so neither depends on scheduling
+    last_eid.set(first_eid);
+    for (int i=0; i<parsed.size(); i++) {
+        if (parsed[i].is_valid()) {
+            _renumber_timeline(parsed[i].ptr());
+            symbols[parsed[i]->token] = parsed[i];
+        }
+    }
+    includes.clear();
+}
+
+void FlashDocument::_renumber_timeline(FlashTimeline *p_timeline) {
+    p_timeline->set_eid(last_eid.postincrement());
+    HashMap<int, int> layer_eids;
+    for (int i=0; i<2; i++) {
+        List<Ref<FlashLayer>> &layers = i == 0 ? p_timeline->masks : p_timeline->layers;
+        for (List<Ref<FlashLayer>>::Element *L = layers.front(); L; L = L->next()) {
+            FlashLayer *layer = L->get().ptr();
+            int eid = last_eid.postincrement();
+            layer_eids[layer->get_eid()] = eid;
+            layer->set_eid(eid);
+            for (List<Ref<FlashFrame>>::Element *F = layer->frames.front(); F; F = F->next()) {
+                FlashFrame *frame = F->get().ptr();
+                frame->set_eid(last_eid.postincrement());
+                for (List<Ref<FlashDrawing>>::Element *E = frame->elements.front(); E; E = E->next()) {
+                    _renumber_drawing(E->get().ptr());
+                }
+                for (List<Ref<FlashTween>>::Element *T = frame->tweens.front(); T; T = T->next()) {
+                    T->get()->set_eid(last_eid.postincrement());
+                }
+            }
+        }
+    }
+    // clipped layers reference their mask layer by id
+    for (int i=0; i<2; i++) {
+        List<Ref<FlashLayer>> &layers = i == 0 ? p_timeline->masks : p_timeline->layers;
+        for (List<Ref<FlashLayer>>::Element *L = layers.front(); L; L = L->next()) {
+            FlashLayer *layer = L->get().ptr();
+            const int *mask_eid = layer->mask_id ? layer_eids.getptr(layer->mask_id) : nullptr;
+            if (mask_eid != nullptr) layer->mask_id = *mask_eid;
+        }
+    }
+}
+
+void FlashDocument::_renumber_drawing(FlashDrawing *p_drawing) {
+    p_drawing->set_eid(last_eid.postincrement());
+    FlashGroup *group = Object::cast_to<FlashGroup>(p_drawing);
+    if (group == nullptr) return;
+    for (List<Ref<FlashDrawing>>::Element *M = group->members.front(); M; M = M->next()) {
+        _renumber_drawing(M->get().ptr());
+    }
 }
 
 void FlashDocument::setup(FlashDocument *p_document, FlashElement *p_parent) {
@@ -350,6 +683,8 @@ void FlashDocument::setup(FlashDocument *p_document, FlashElement *p_parent) {
     }
 
     cache_variants();
+    cache_clips();
+    cache_static();
 }
 Ref<FlashTextureRect> FlashDocument::get_bitmap_rect(const String &p_name) {
     if (!bitmaps.has(p_name)) {
@@ -403,8 +738,7 @@ Error FlashDocument::parse(Ref<XMLParser> xml) {
             bitmaps[bitmap->get_name()] = bitmap;
         }
         else if (xml->get_node_type() == XMLParser::NODE_ELEMENT && xml->get_node_name() == "Include" && xml->has_attribute("href")) {
-            String path = xml->get_named_attribute_value("href");
-            parse_timeline(path);
+            includes.push_back(xml->get_named_attribute_value("href"));
         }
     }
     return Error::OK;
@@ -448,6 +782,7 @@ void FlashTimeline::_bind_methods() {
     ClassDB::bind_method(D_METHOD("set_clips_header", "clips_header"), &FlashTimeline::set_clips_header);
     ClassDB::bind_method(D_METHOD("get_duration"), &FlashTimeline::get_duration);
     ClassDB::bind_method(D_METHOD("set_duration", "duration"), &FlashTimeline::set_duration);
+    ClassDB::bind_method(D_METHOD("get_bounds"), &FlashTimeline::get_bounds_rect);
 
     ADD_PROPERTY(PropertyInfo(Variant::ARRAY, "layers", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NO_EDITOR | PROPERTY_USAGE_INTERNAL ), "set_layers", "get_layers");
     ADD_PROPERTY(PropertyInfo(Variant::DICTIONARY, "variants", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NO_EDITOR | PROPERTY_USAGE_INTERNAL ), "set_variants", "get_variants");
@@ -507,13 +842,189 @@ void FlashTimeline::add_label(const String &label_name, const String &label_type
     }
     //labels[label_name] = Vector2(start, start+label_duration);
 }
+void FlashTimeline::ensure_loaded() {
+    if (!loaded.is_set() && document != nullptr) {
+        document->load_symbol(this);
+    }
+    // usage stamp for evict_unused_symbols, written once per frame
+    uint64_t frame = Engine::get_singleton()->get_process_frames();
+    if (last_used.get() != frame) last_used.set(frame);
+}
+bool FlashTimeline::_compute_bakeable() {
+    // nested symbols are evaluated without delta when baked,
+    // so only trees without nested events can be baked
+    for (int i=0; i<layer_table.size() + mask_table.size(); i++) {
+        FlashLayer *layer = i < layer_table.size() ? layer_table[i] : mask_table[i - layer_table.size()];
+        for (int k=0; k<layer->keyframes.size(); k++) {
+            FlashFrame *frame = layer->keyframes[k];
+            for (int e=0; e<frame->get_elements_count(); e++) {
+                if (!frame->is_element_bakeable(e)) return false;
+            }
+        }
+    }
+    return true;
+}
+bool FlashTimeline::is_bakeable() {
+    ensure_loaded();
+    // memos are computed once under the symbols mutex, players read them
+    // from worker threads while lazy symbols may be set up on others
+    int state = bakeable.get();
+    if (state >= 0 || document == nullptr) return state > 0;
+    MutexLock lock(document->get_symbols_mutex());
+    state = bakeable.get();
+    // nested in itself, the outer call decides
+    if (state == MEMO_COMPUTING) return true;
+    if (state < 0) {
+        bakeable.set(MEMO_COMPUTING);
+        state = _compute_bakeable() ? 1 : 0;
+        bakeable.set(state);
+    }
+    return state > 0;
+}
+bool FlashTimeline::_compute_static() {
+    // a timeline is static when every layer holds a single keyframe
+    // from the first frame and its content is static too, so the output
+    // does not depend on the frame, clips or variants
+    if (mask_table.size() > 0 || events.size() > 0) return false;
+    for (int i=0; i<layer_table.size(); i++) {
+        FlashLayer *layer = layer_table[i];
+        if (layer->skip_processing || layer->keyframes.size() == 0) continue;
+        if (layer->keyframes.size() > 1 || layer->keyframes[0]->get_index() > 0) return false;
+        if (!layer->keyframes[0]->has_static_elements()) return false;
+    }
+    return true;
+}
+bool FlashTimeline::is_static() {
+    ensure_loaded();
+    int state = static_tree.get();
+    if (state >= 0 || document == nullptr) return state > 0;
+    MutexLock lock(document->get_symbols_mutex());
+    state = static_tree.get();
+    // nested in itself, so not static
+    if (state == MEMO_COMPUTING) return false;
+    if (state < 0) {
+        static_tree.set(MEMO_COMPUTING);
+        state = _compute_static() ? 1 : 0;
+        static_tree.set(state);
+    }
+    return state > 0;
+}
+void FlashTimeline::cache_static() {
+    ensure_loaded();
+    is_static();
+    for (int i=0; i<layer_table.size() + mask_table.size(); i++) {
+        FlashLayer *layer = i < layer_table.size() ? layer_table[i] : mask_table[i - layer_table.size()];
+        for (int k=0; k<layer->keyframes.size(); k++) {
+            layer->keyframes[k]->has_static_elements();
+        }
+    }
+    Rect2 r;
+    get_bounds(r);
+}
+static inline Transform2D _lerp_transform(const Transform2D &p_from, const Transform2D &p_to, float p_amount) {
+    // same component-wise lerp layers use for tweened elements
+    Vector2 x = p_from[0].lerp(p_to[0], p_amount);
+    Vector2 y = p_from[1].lerp(p_to[1], p_amount);
+    Vector2 o = p_from[2].lerp(p_to[2], p_amount);
+    return Transform2D(x.x, x.y, y.x, y.y, o.x, o.y);
+}
+bool FlashTimeline::get_bounds(Rect2 &r_bounds) {
+    ensure_loaded();
+    int state = bounds_state.get();
+    if (state <= 0 && document != nullptr) {
+        // computed under the symbols mutex like the other memos, culling
+        // asks from the main thread while workers may set symbols up
+        MutexLock lock(document->get_symbols_mutex());
+        state = bounds_state.get();
+        // recursive symbol, its bounds are whatever the outer call collects
+        if (state == 0) return false;
+        if (state < 0) {
+            bounds_state.set(0);
+            state = _compute_bounds(bounds) ? 1 : 2;
+            bounds_state.set(state);
+        }
+    }
+    r_bounds = bounds;
+    return state == 1;
+}
+bool FlashTimeline::_compute_bounds(Rect2 &r_bounds) {
+    bool has_bounds = false;
+    Rect2 result;
+    // mask layers only limit what is drawn, so content layers alone are conservative
+    for (int i=0; i<layer_table.size(); i++) {
+        FlashLayer *layer = layer_table[i];
+        if (layer->skip_processing) continue;
+        for (int k=0; k<layer->keyframes.size(); k++) {
+            FlashFrame *current = layer->keyframes[k];
+            FlashFrame *next = k + 1 < layer->keyframes.size() ? layer->keyframes[k + 1] : nullptr;
+            // element transforms are lerped linearly, so the extreme eased amounts
+            // bound every tweened position, overshooting eases included
+            float amount_min = 0.0;
+            float amount_max = 0.0;
+            if (current->tween != nullptr && next != nullptr) {
+                current->tween->get_interpolation_range(amount_min, amount_max);
+            }
+            for (int idx=0; idx<current->get_elements_count(); idx++) {
+                Rect2 content;
+                if (!current->get_element_bounds(idx, content)) continue;
+                Transform2D tr = current->get_element_transform(idx);
+                Rect2 rect = tr.xform(content);
+                if (next != nullptr && next->get_elements_count() >= idx+1 && (amount_min != 0.0 || amount_max != 0.0)) {
+                    Transform2D to = next->get_element_transform(idx);
+                    rect = rect.merge(_lerp_transform(tr, to, amount_min).xform(content));
+                    rect = rect.merge(_lerp_transform(tr, to, amount_max).xform(content));
+                }
+                result = has_bounds ? result.merge(rect) : rect;
+                has_bounds = true;
+            }
+        }
+    }
+    r_bounds = result;
+    return has_bounds;
+}
+Rect2 FlashTimeline::get_bounds_rect() {
+    Rect2 r;
+    get_bounds(r);
+    return r;
+}
+bool FlashTimeline::get_baked_frame(int p_frame, FlashBakedFrame &r_baked) const {
+    MutexLock lock(baked_mutex);
+    if (p_frame < 0 || p_frame >= baked_frames.size()) return false;
+    if (!baked_frames[p_frame].valid) return false;
+    r_baked = baked_frames[p_frame];
+    return true;
+}
+void FlashTimeline::set_baked_frame(int p_frame, const FlashBakedFrame &p_baked) {
+    MutexLock lock(baked_mutex);
+    ERR_FAIL_COND(p_frame < 0 || p_frame >= MAX(duration, 1));
+    if (baked_frames.size() != MAX(duration, 1)) {
+        baked_frames.resize(MAX(duration, 1));
+    }
+    if (baked_frames[p_frame].valid) return;
+    baked_frames.write[p_frame] = p_baked;
+    baked_frames.write[p_frame].valid = true;
+}
+void FlashTimeline::clear_baked_frames() {
+    MutexLock lock(baked_mutex);
+    baked_frames.clear();
+}
 void FlashTimeline::setup(FlashDocument *p_document, FlashElement *p_parent) {
     FlashElement::setup(p_document, p_parent);
+    bakeable.set(-1);
+    static_tree.set(-1);
+    bounds_state.set(-1);
+    clear_baked_frames();
+    layer_table.clear();
+    mask_table.clear();
+    // content of lazy symbols is compiled once FlashDocument::load_symbol sets them up
+    if (!loaded.is_set() && !loading) return;
     for (List<Ref<FlashLayer>>::Element *E = layers.front(); E; E = E->next()) {
         E->get()->setup(document, this);
+        layer_table.push_back(E->get().ptr());
     }
     for (List<Ref<FlashLayer>>::Element *E = masks.front(); E; E = E->next()) {
         E->get()->setup(document, this);
+        mask_table.push_back(E->get().ptr());
     }
 
 }
@@ -548,7 +1059,7 @@ Error FlashTimeline::parse(Ref<XMLParser> xml) {
     }
     return Error::OK;
 }
-void FlashTimeline::animation_process(FlashPlayer* node, float time, float delta, Transform2D tr, FlashColorEffect effect) {
+void FlashTimeline::process_events(FlashPlayer* node, float time, float delta) {
     if (events.size() && delta > 0.0) {
         float event_frame_start = -2.0;
         float event_frame_end = -2.0;
@@ -573,12 +1084,15 @@ void FlashTimeline::animation_process(FlashPlayer* node, float time, float delta
             }
         }
     }
-
-    for (List<Ref<FlashLayer>>::Element *E = masks.front(); E; E = E->next()) {
-        E->get()->animation_process(node, time, delta, tr, effect);
+}
+void FlashTimeline::animation_process(FlashPlayer* node, float time, float delta, Transform2D tr, FlashColorEffect effect) {
+    ensure_loaded();
+    process_events(node, time, delta);
+    for (int i=0; i<mask_table.size(); i++) {
+        mask_table[i]->animation_process(node, time, delta, tr, effect);
     }
-    for (List<Ref<FlashLayer>>::Element *E = layers.back(); E; E = E->prev()) {
-        E->get()->animation_process(node, time, delta, tr, effect);
+    for (int i=layer_table.size()-1; i>=0; i--) {
+        layer_table[i]->animation_process(node, time, delta, tr, effect);
     }
 }
 
@@ -621,10 +1135,34 @@ void FlashLayer::set_frames(Array p_frames) {
 }
 void FlashLayer::setup(FlashDocument *p_document, FlashElement *p_parent) {
     FlashElement::setup(p_document, p_parent);
+    skip_processing = type == "guide" || type == "folder";
+    is_mask = type == "mask";
+    keyframes.clear();
     for (List<Ref<FlashFrame>>::Element *E = frames.front(); E; E = E->next()) {
         E->get()->setup(document, this);
+        keyframes.push_back(E->get().ptr());
+    }
+
+    frame_table.resize(MAX(duration, 0));
+    int *w = frame_table.ptrw();
+    for (int i=0; i<frame_table.size(); i++) {
+        w[i] = -1;
+    }
+    for (int k=0; k<keyframes.size(); k++) {
+        int start = MAX(keyframes[k]->get_index(), 0);
+        int end = k+1 < keyframes.size() ? keyframes[k+1]->get_index() : frame_table.size();
+        for (int i=start; i<MIN(end, frame_table.size()); i++) {
+            w[i] = k;
+        }
     }
 }
+int FlashLayer::get_keyframe_idx(int p_frame) const {
+    if (p_frame < 0 || keyframes.size() == 0) return -1;
+    if (p_frame < frame_table.size()) return frame_table[p_frame];
+    // past the layer end (time == duration), fall back to the last keyframe
+    int last = keyframes.size() - 1;
+    return keyframes[last]->get_index() <= p_frame ? last : -1;
+}
 Error FlashLayer::parse(Ref<XMLParser> xml) {
     if (xml->has_attribute("name"))
         layer_name = xml->get_named_attribute_value("name");
@@ -662,74 +1200,62 @@ Error FlashLayer::parse(Ref<XMLParser> xml) {
     return Error::OK;
 };
 void FlashLayer::animation_process(FlashPlayer* node, float time, float delta, Transform2D parent_transform, FlashColorEffect parent_effect) {
-    if (type == "guide") return;
-    if (type == "folder") return;
-    if (type == "mask") node->mask_begin(get_eid());
+    if (skip_processing) return;
+    if (is_mask) node->mask_begin(get_eid());
     if (mask_id) node->clip_begin(mask_id);
 
     float frame_time = time;
     while (duration > 0 && frame_time > duration) frame_time -= duration;
-    int frame_idx = static_cast<int>(floor(frame_time));
+    int keyframe_idx = get_keyframe_idx(static_cast<int>(floor(frame_time)));
+    if (keyframe_idx < 0) return;
 
-    Ref<FlashFrame> current;
-    Ref<FlashFrame> next;
-    for (List<Ref<FlashFrame>>::Element *E = frames.front(); E; E = E->next()) {
-        if (E->get()->get_index() > frame_idx) {
-            break;
-        }
-        current = E->get();
-        if (E->next()) next = E->next()->get();
-    }
-
-    if (!current.is_valid()) return;
+    FlashFrame *current = keyframes[keyframe_idx];
+    FlashFrame *next = keyframe_idx + 1 < keyframes.size() ? keyframes[keyframe_idx + 1] : nullptr;
 
     float interpolation = 0;
     float current_time = frame_time - current->get_index();
-    if (current->tweens.size() > 0){
-        Ref<FlashTween>tween = current->tweens.front()->get();
-        interpolation = tween->interpolate(current_time/current->get_duration());
-    }
-
-    int idx = 0;
-    for (List<Ref<FlashDrawing>>::Element *E = current->elements.front(); E; E = E->next()) {
-        Ref<FlashDrawing> elem = E->get();
-        Transform2D tr = elem->get_transform();
-        FlashColorEffect effect = current->color_effect;
-        FlashInstance *inst = Object::cast_to<FlashInstance>(elem.ptr());
-        if (inst != NULL) {
-            effect = inst->color_effect * effect;
+    if (current->tween != nullptr){
+        interpolation = current->tween->interpolate(current_time/current->get_duration());
+    }
+
+    // static content only depends on the keyframe, interpolation and inherited state,
+    // so the range emitted for the previous frame may be reused as is
+    int cache_slot = -1;
+    if (!is_mask && current->has_static_elements()) {
+        FlashLayerCacheEntry entry;
+        entry.layer = this;
+        entry.keyframe = keyframe_idx;
+        entry.interpolation = next != nullptr ? interpolation : 0.0;
+        entry.transform = parent_transform;
+        entry.add = parent_effect.add;
+        entry.mult = parent_effect.mult;
+        if (node->layer_cache_begin(entry, cache_slot)) {
+            if (mask_id) node->clip_end(mask_id);
+            return;
         }
+    }
+
+    int elements_count = current->get_elements_count();
+    const FlashColorEffect *effects = current->element_effects.ptr();
+    for (int idx=0; idx<elements_count; idx++) {
+        Transform2D tr = current->get_element_transform(idx);
+        FlashColorEffect effect = effects[idx];
         FlashColorEffect next_effect = effect;
 
-        if (next.is_valid() && next->elements.size() >= idx+1) {
-            // Get element at index idx from List using iterator
-            Ref<FlashDrawing> next_elem;
-            int current_idx = 0;
-            for (const Ref<FlashDrawing>& elem : next->elements) {
-                if (current_idx == idx) {
-                    next_elem = elem;
-                    break;
-                }
-                current_idx++;
-            }
-            Transform2D to = next_elem->get_transform();
+        if (next != nullptr && next->get_elements_count() >= idx+1) {
+            Transform2D to = next->get_element_transform(idx);
             Vector2 x = tr[0].lerp(to[0], interpolation);
             Vector2 y = tr[1].lerp(to[1], interpolation);
             Vector2 o = tr[2].lerp(to[2], interpolation);
             tr = Transform2D(x.x, x.y, y.x, y.y, o.x, o.y);
-            FlashInstance *next_inst = Object::cast_to<FlashInstance>(next_elem.ptr());
-            next_effect = next->color_effect;
-            if (next_inst != NULL) {
-                next_effect = next_inst->color_effect*next_effect;
-            }
+            next_effect = next->element_effects[idx];
         }
         effect = effect.interpolate(next_effect, interpolation);
 
-
-        elem->animation_process(node, frame_time - current->get_index(), delta, parent_transform * tr, effect*parent_effect);
-        idx++;
+        current->element_process(idx, node, current_time, delta, parent_transform * tr, effect*parent_effect);
     }
-    if (type == "mask") node->mask_end(get_eid());
+    if (cache_slot >= 0) node->layer_cache_end(cache_slot);
+    if (is_mask) node->mask_end(get_eid());
     if (mask_id) node->clip_end(mask_id);
 }
 
@@ -795,12 +1321,22 @@ void FlashFrame::set_color_effect(PackedColorArray p_color_effect) {
 }
 Array FlashFrame::get_elements() {
     Array l;
+    if (binary_frame >= 0 && document != nullptr) {
+        // records of binary documents are only turned into objects on request
+        List<Ref<FlashDrawing>> binary_elements;
+        document->read_binary_elements(this, &binary_elements);
+        for (List<Ref<FlashDrawing>>::Element *E = binary_elements.front(); E; E = E->next()) {
+            l.push_back(E->get());
+        }
+        return l;
+    }
     for (List<Ref<FlashDrawing>>::Element *E = elements.front(); E; E = E->next()) {
         l.push_back(E->get());
     }
     return l;
 }
 void FlashFrame::set_elements(Array p_elements) {
+    binary_frame = -1;
     elements.clear();
     for (int i=0; i<p_elements.size(); i++) {
         Ref<FlashDrawing> element = p_elements[i];
@@ -826,12 +1362,65 @@ void FlashFrame::set_tweens(Array p_tweens) {
 }
 void FlashFrame::setup(FlashDocument *p_document, FlashElement *p_parent) {
     FlashElement::setup(p_document, p_parent);
-    for (List<Ref<FlashDrawing>>::Element *E = elements.front(); E; E = E->next()) {
-        E->get()->setup(document, this);
+    element_table.clear();
+    element_effects.clear();
+    binary_refs = nullptr;
+    elements_count = 0;
+    if (binary_frame >= 0 && document != nullptr) {
+        // also reads the frame tweens when they are not read yet
+        document->setup_binary_frame(this);
+    } else {
+        for (List<Ref<FlashDrawing>>::Element *E = elements.front(); E; E = E->next()) {
+            E->get()->setup(document, this);
+            FlashDrawing *elem = E->get().ptr();
+            FlashInstance *inst = Object::cast_to<FlashInstance>(elem);
+            element_table.push_back(elem);
+            element_effects.push_back(inst != NULL ? inst->color_effect * color_effect : color_effect);
+        }
+        elements_count = element_table.size();
     }
     for (List<Ref<FlashTween>>::Element *E = tweens.front(); E; E = E->next()) {
         E->get()->setup(document, this);
     }
+    tween = tweens.size() > 0 ? tweens.front()->get().ptr() : nullptr;
+    static_elements.set(-1);
+}
+bool FlashFrame::has_static_elements() {
+    int state = static_elements.get();
+    if (state >= 0 || document == nullptr) return state > 0;
+    // same scheme as the timeline memos, see FlashTimeline::is_static
+    MutexLock lock(document->get_symbols_mutex());
+    state = static_elements.get();
+    if (state < 0) {
+        state = 1;
+        for (int i=0; i<elements_count; i++) {
+            if (!is_element_static(i)) {
+                state = 0;
+                break;
+            }
+        }
+        static_elements.set(state);
+    }
+    return state > 0;
+}
+Transform2D FlashFrame::get_element_transform(int p_idx) const {
+    return binary_refs != nullptr ? document->get_binary_transform(binary_refs[p_idx]) : element_table[p_idx]->get_transform();
+}
+bool FlashFrame::is_element_bakeable(int p_idx) {
+    return binary_refs != nullptr ? document->is_binary_element_bakeable(binary_refs[p_idx]) : element_table[p_idx]->is_bakeable();
+}
+bool FlashFrame::is_element_static(int p_idx) {
+    return binary_refs != nullptr ? document->is_binary_element_static(binary_refs[p_idx]) : element_table[p_idx]->is_static();
+}
+bool FlashFrame::get_element_bounds(int p_idx, Rect2 &r_bounds) {
+    return binary_refs != nullptr ? document->get_binary_element_bounds(binary_refs[p_idx], r_bounds) : element_table[p_idx]->get_bounds(r_bounds);
+}
+void FlashFrame::element_process(int p_idx, FlashPlayer* node, float time, float delta, const Transform2D &tr, const FlashColorEffect &effect) {
+    if (binary_refs != nullptr) {
+        document->binary_element_process(binary_refs[p_idx], node, time, delta, tr, effect);
+    } else {
+        element_table[p_idx]->animation_process(node, time, delta, tr, effect);
+    }
 }
 Error FlashFrame::parse(Ref<XMLParser> xml) {
     if (xml->has_attribute("index")) index = xml->get_named_attribute_value("index").to_int();
@@ -914,6 +1503,29 @@ void FlashGroup::set_members(Array p_members) {
         }
     }
 }
+bool FlashGroup::is_bakeable() {
+    for (int i=0; i<member_table.size(); i++) {
+        if (!member_table[i]->is_bakeable()) return false;
+    }
+    return true;
+}
+bool FlashGroup::is_static() {
+    for (int i=0; i<member_table.size(); i++) {
+        if (!member_table[i]->is_static()) return false;
+    }
+    return true;
+}
+bool FlashGroup::get_bounds(Rect2 &r_bounds) {
+    // members are drawn with the group transform, see `animation_process`
+    bool has_bounds = false;
+    for (int i=0; i<member_table.size(); i++) {
+        Rect2 member;
+        if (!member_table[i]->get_bounds(member)) continue;
+        r_bounds = has_bounds ? r_bounds.merge(member) : member;
+        has_bounds = true;
+    }
+    return has_bounds;
+}
 List<Ref<FlashDrawing>> FlashGroup::all_members() const {
     List<Ref<FlashDrawing>> result;
     List<const FlashGroup*> groups;
@@ -936,6 +1548,11 @@ void FlashGroup::setup(FlashDocument *p_document, FlashElement *p_parent) {
     for (List<Ref<FlashDrawing>>::Element *E = members.front(); E; E = E->next()) {
         E->get()->setup(document, this);
     }
+    member_table.clear();
+    List<Ref<FlashDrawing>> ms = all_members();
+    for (List<Ref<FlashDrawing>>::Element *E = ms.front(); E; E = E->next()) {
+        member_table.push_back(E->get().ptr());
+    }
 }
 Error FlashGroup::parse(Ref<XMLParser> xml) {
     if (xml->is_empty()) return Error::OK;
@@ -955,9 +1572,8 @@ Error FlashGroup::parse(Ref<XMLParser> xml) {
     return Error::OK;
 }
 void FlashGroup::animation_process(FlashPlayer* node, float time, float delta, Transform2D tr, FlashColorEffect effect) {
-    List<Ref<FlashDrawing>> ms = all_members();
-    for (List<Ref<FlashDrawing>>::Element *E = ms.front(); E; E = E->next()) {
-        E->get()->animation_process(node, time, delta, tr, effect);
+    for (int i=0; i<member_table.size(); i++) {
+        member_table[i]->animation_process(node, time, delta, tr, effect);
     }
 }
 
@@ -979,12 +1595,39 @@ void FlashInstance::_bind_methods() {
 void FlashInstance::setup(FlashDocument *p_document, FlashElement *p_parent) {
     FlashDrawing::setup(p_document, p_parent);
     layer_name = find_parent<FlashLayer>()->get_layer_name();
+    set_loop(loop);
+    // only the pointer is resolved, lazy symbols load once evaluated
+    timeline = document ? document->find_symbol(timeline_token) : nullptr;
+}
+int FlashInstance::parse_loop_mode(const String &p_loop) {
+    return
+        p_loop == "single frame"  ? SINGLE_FRAME :
+        p_loop == "play once"     ? PLAY_ONCE :
+                                    LOOP;
+}
+void FlashInstance::set_loop(String p_loop) {
+    loop = p_loop;
+    loop_mode = (LoopMode)parse_loop_mode(loop);
 }
 FlashTimeline* FlashInstance::get_timeline() {
-    if (timeline != nullptr) return timeline;
-    timeline = document->get_timeline(timeline_token);
+    if (timeline == nullptr && document != nullptr) timeline = document->find_symbol(timeline_token);
+    if (timeline != nullptr) timeline->ensure_loaded();
     return timeline;
 }
+bool FlashInstance::is_bakeable() {
+    FlashTimeline *tl = get_timeline();
+    if (tl == nullptr) return true;
+    return tl->get_events().size() == 0 && tl->is_bakeable();
+}
+bool FlashInstance::is_static() {
+    FlashTimeline *tl = get_timeline();
+    return tl == nullptr || tl->is_static();
+}
+bool FlashInstance::get_bounds(Rect2 &r_bounds) {
+    // covers every frame, so loop mode and frame overrides do not matter
+    FlashTimeline *tl = get_timeline();
+    return tl != nullptr && tl->get_bounds(r_bounds);
+}
 PackedColorArray FlashInstance::get_color_effect() const {
     PackedColorArray effect;
     effect.push_back(color_effect.add);
@@ -1034,18 +1677,20 @@ Error FlashInstance::parse(Ref<XMLParser> xml) {
     }
     return Error::OK;
 }
-void FlashInstance::animation_process(FlashPlayer* node, float time, float delta, Transform2D tr, FlashColorEffect effect) {
-    FlashTimeline* tl = get_timeline();
-    if (tl == NULL) return;
+void FlashInstance::process_timeline(FlashPlayer* node, FlashTimeline *p_timeline, int p_loop_mode, int p_first_frame, float time, float delta, const Transform2D &tr, const FlashColorEffect &effect) {
+    if (p_timeline == NULL) return;
+    p_timeline->ensure_loaded();
     float instance_time =
-        loop == "single frame"  ? first_frame :
-        loop == "play once"     ? MIN(first_frame + time, tl->get_duration()-0.001) :
-                                  first_frame + time;
-
-    instance_time = node->get_symbol_frame(tl, instance_time);
+        p_loop_mode == SINGLE_FRAME   ? p_first_frame :
+        p_loop_mode == PLAY_ONCE      ? MIN(p_first_frame + time, p_timeline->get_duration()-0.001) :
+                                        p_first_frame + time;
 
-    tl->animation_process(node, instance_time, delta, tr, effect);
+    instance_time = node->get_symbol_frame(p_timeline, instance_time);
 
+    p_timeline->animation_process(node, instance_time, delta, tr, effect);
+}
+void FlashInstance::animation_process(FlashPlayer* node, float time, float delta, Transform2D tr, FlashColorEffect effect) {
+    process_timeline(node, get_timeline(), loop_mode, first_frame, time, delta, tr, effect);
 }
 
 void FlashBitmapInstance::_bind_methods(){
@@ -1068,6 +1713,22 @@ Error FlashBitmapInstance::parse(Ref<XMLParser> xml) {
     return Error::OK;
 }
 
+void FlashBitmapInstance::setup(FlashDocument *p_document, FlashElement *p_parent) {
+    FlashDrawing::setup(p_document, p_parent);
+    // resolved once here, animation_process may run on worker threads
+    texture = document ? document->get_bitmap_rect(library_item_name) : Ref<FlashTextureRect>();
+}
+
+bool FlashBitmapInstance::get_texture_bounds(const FlashTextureRect *p_texture, Rect2 &r_bounds) {
+    if (p_texture == nullptr || p_texture->get_region().size == Vector2()) return false;
+    r_bounds = p_texture->get_region_transform().xform(Rect2(Vector2(), p_texture->get_region().size));
+    return true;
+}
+
+bool FlashBitmapInstance::get_bounds(Rect2 &r_bounds) {
+    return get_texture_bounds(texture.ptr(), r_bounds);
+}
+
 Ref<FlashTextureRect> FlashBitmapInstance::get_texture() {
     if (texture.is_null()) {
         if (!document) {
@@ -1075,13 +1736,14 @@ Ref<FlashTextureRect> FlashBitmapInstance::get_texture() {
             // 不打印错误，只是返回空引用
             return Ref<FlashTextureRect>();
         }
-        texture = document->get_bitmap_rect(library_item_name);
-        if (texture.is_null()) {
+        Ref<FlashTextureRect> tex = document->get_bitmap_rect(library_item_name);
+        if (tex.is_null()) {
             // 只在调试模式下打印此消息，避免在正常播放时产生大量日志
             if (OS::get_singleton()->is_stdout_verbose()) {
                 print_line("调试信息: 无法获取位图 " + library_item_name + " 的纹理矩形");
             }
         }
+        return tex;
     }
     return texture;
 }
@@ -1095,17 +1757,19 @@ void FlashBitmapInstance::animation_process(FlashPlayer* node, float time, float
         }
         return;
     }
-    
+    draw_texture(node, document, tex.ptr(), tr, effect);
+}
+
+void FlashBitmapInstance::draw_texture(FlashPlayer* node, FlashDocument *p_document, const FlashTextureRect *tex, const Transform2D &tr, const FlashColorEffect &effect) {
+    if (tex == nullptr) return;
     // 检查纹理图集是否有效
-    if (!document || !document->get_atlas().is_valid()) {
+    if (!p_document || !p_document->get_atlas().is_valid()) {
         // 纹理图集无效，但这可能是预期的情况（例如，在设置资源之前）
         return;
     }
     
     if (node->is_masking()) {
-        Transform2D scale;
-        scale.scale(tex->get_original_size()/tex->get_region().size);
-        node->mask_add(tr * scale, tex->get_region(), tex->get_index());
+        node->mask_add(tr * tex->get_region_transform(), tex->get_region(), tex->get_index());
         return;
     }
     // if (node->is_masking()) {
@@ -1117,7 +1781,6 @@ void FlashBitmapInstance::animation_process(FlashPlayer* node, float time, float
     // }
 
     //node->draw_set_transform_matrix(tr);
-    Vector<Color> colors;
     // 高级颜色效果处理
     // 在Flash中，乘法颜色(Multiplier)范围是0-1，加法颜色(Offset)范围是0-255
     // 在Godot中，颜色通道值范围是0-1
@@ -1132,37 +1795,45 @@ void FlashBitmapInstance::animation_process(FlashPlayer* node, float time, float
     color.g += effect.add.g;
     color.b += effect.add.b;
     color.a += effect.add.a;
-    colors.push_back(color);
-    colors.push_back(color);
-    colors.push_back(color);
-    colors.push_back(color);
-    Vector<Vector2> points;
-    Vector2 size = tex->get_original_size();
-    points.push_back(tr.xform(Vector2()));
-    points.push_back(tr.xform(Vector2(size.x, 0)));
-    points.push_back(tr.xform(size));
-    points.push_back(tr.xform(Vector2(0, size.y)));
-
-    if (uvs.size()  == 0) {
-        Vector2 as = document->get_atlas_size();
-        if (as.x <= 0 || as.y <= 0) {
-            // 纹理图集大小无效，可能是纹理图集未正确加载
-            if (OS::get_singleton()->is_stdout_verbose()) {
-                print_line("调试信息: 纹理图集大小无效 (" + String::num_real(as.x) + "," + String::num_real(as.y) + ")");
-            }
-            return;
+    // region corners mapped to the bitmap space, handles trimmed and rotated regions
+    Transform2D region_tr = tr * tex->get_region_transform();
+    Rect2 r = tex->get_region();
+    Vector2 size = r.size;
+    Vector2 points[4] = {
+        region_tr.xform(Vector2()),
+        region_tr.xform(Vector2(size.x, 0)),
+        region_tr.xform(size),
+        region_tr.xform(Vector2(0, size.y))
+    };
+
+    Vector2 as = p_document->get_atlas_size();
+    if (as.x <= 0 || as.y <= 0) {
+        // 纹理图集大小无效，可能是纹理图集未正确加载
+        if (OS::get_singleton()->is_stdout_verbose()) {
+            print_line("调试信息: 纹理图集大小无效 (" + String::num_real(as.x) + "," + String::num_real(as.y) + ")");
         }
-        
-        Rect2 r = tex->get_region();
-        Vector2 start = r.position / as;
-        Vector2 end = (r.position + r.size) / as;
-        uvs.push_back(start);
-        uvs.push_back(Vector2(end.x, start.y));
-        uvs.push_back(end);
-        uvs.push_back(Vector2(start.x, end.y));
+        return;
     }
 
-    node->add_polygon(points, colors, uvs, tex->get_index());
+    // tight outline skips transparent texels of the region
+    const Vector<Vector2> &polygon = tex->get_polygon();
+    int polygon_size = polygon.size();
+    if (polygon_size >= 3 && polygon_size <= FlashTextureRect::MAX_POLYGON_POINTS) {
+        Vector2 polygon_points[FlashTextureRect::MAX_POLYGON_POINTS];
+        Vector2 polygon_uvs[FlashTextureRect::MAX_POLYGON_POINTS];
+        const Vector2 *r_polygon = polygon.ptr();
+        for (int i=0; i<polygon_size; i++) {
+            polygon_points[i] = region_tr.xform(r_polygon[i]);
+            polygon_uvs[i] = (r.position + r_polygon[i]) / as;
+        }
+        node->add_convex_polygon(polygon_points, polygon_uvs, polygon_size, color, tex->get_index());
+        return;
+    }
+
+    // computed per call instead of cached, instances may be processed concurrently
+    Rect2 uv_rect(r.position / as, r.size / as);
+
+    node->add_quad(points, color, uv_rect, tex->get_index());
 }
 
 void FlashTween::_bind_methods() {
@@ -1295,8 +1966,69 @@ inline float __ease_out_bounce(float x) {
     }
 }
 
+void FlashTween::setup(FlashDocument *p_document, FlashElement *p_parent) {
+    FlashElement::setup(p_document, p_parent);
+    build_lut();
+}
+
+void FlashTween::build_lut() {
+    // built once at setup, players read it from worker threads
+    lut.clear();
+    if (method == NONE) return;
+    lut.resize(LUT_SIZE + 1);
+    float *w = lut.ptrw();
+    for (int i=0; i<=LUT_SIZE; i++) {
+        w[i] = evaluate((float)i / LUT_SIZE);
+    }
+}
+
+float FlashTween::interpolate(float time) const {
+    if (lut.size() != LUT_SIZE + 1 || time < 0.0 || time > 1.0) return evaluate(time);
+    float position = time * LUT_SIZE;
+    int idx = MIN((int)position, LUT_SIZE - 1);
+    const float *r = lut.ptr();
+    return r[idx] + (r[idx + 1] - r[idx]) * (position - idx);
+}
+
+void FlashTween::interpolate_batch(const float *p_times, float *r_values, int p_count) const {
+    if (lut.size() != LUT_SIZE + 1) {
+        for (int i=0; i<p_count; i++) {
+            r_values[i] = evaluate(p_times[i]);
+        }
+        return;
+    }
+    // branch free over one table, times are clamped to [0, 1]
+    const float *r = lut.ptr();
+    for (int i=0; i<p_count; i++) {
+        float position = CLAMP(p_times[i], 0.0f, 1.0f) * LUT_SIZE;
+        int idx = MIN((int)position, LUT_SIZE - 1);
+        r_values[i] = r[idx] + (r[idx + 1] - r[idx]) * (position - idx);
+    }
+}
+
+void FlashTween::get_interpolation_range(float &r_min, float &r_max) const {
+    // sampled, back and elastic eases leave [0, 1] in between keyframes
+    static const int STEPS = LUT_SIZE;
+    float times[STEPS + 1];
+    float values[STEPS + 1];
+    for (int i=0; i<=STEPS; i++) {
+        times[i] = (float)i / STEPS;
+    }
+    interpolate_batch(times, values, STEPS + 1);
+    r_min = 0.0;
+    r_max = 1.0;
+    for (int i=0; i<=STEPS; i++) {
+        r_min = MIN(r_min, values[i]);
+        r_max = MAX(r_max, values[i]);
+    }
+    // peaks between samples
+    float pad = (r_max - r_min) * 0.02;
+    if (r_min < 0.0) r_min -= pad;
+    if (r_max > 1.0) r_max += pad;
+}
+
 // easing calculations taken from https://easings.net/
-float FlashTween::interpolate(float time) {
+float FlashTween::evaluate(float time) const {
     switch (method) {
         case NONE: return time;
         case CLASSIC: return Math::ease(time, intensity);
@@ -1413,11 +2145,31 @@ void FlashTextureRect::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_margin"), &FlashTextureRect::get_margin);
     ClassDB::bind_method(D_METHOD("set_original_size", "original_size"), &FlashTextureRect::set_original_size);
 	ClassDB::bind_method(D_METHOD("get_original_size"), &FlashTextureRect::get_original_size);
+    ClassDB::bind_method(D_METHOD("set_rotated", "rotated"), &FlashTextureRect::set_rotated);
+	ClassDB::bind_method(D_METHOD("is_rotated"), &FlashTextureRect::is_rotated);
+	ClassDB::bind_method(D_METHOD("get_region_transform"), &FlashTextureRect::get_region_transform);
+    ClassDB::bind_method(D_METHOD("set_polygon", "polygon"), &FlashTextureRect::set_polygon);
+	ClassDB::bind_method(D_METHOD("get_polygon"), &FlashTextureRect::get_polygon);
 
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "index"), "set_index", "get_index");
 	ADD_PROPERTY(PropertyInfo(Variant::RECT2, "region"), "set_region", "get_region");
 	ADD_PROPERTY(PropertyInfo(Variant::RECT2, "margin"), "set_margin", "get_margin");
     ADD_PROPERTY(PropertyInfo(Variant::VECTOR2, "original_size"), "set_original_size", "get_original_size");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "rotated"), "set_rotated", "is_rotated");
+    ADD_PROPERTY(PropertyInfo(Variant::PACKED_VECTOR2_ARRAY, "polygon"), "set_polygon", "get_polygon");
+}
+
+Transform2D FlashTextureRect::get_region_transform() const {
+    // maps atlas region pixels to bitmap space (original size units)
+    Vector2 content_size = original_size - margin.size;
+    Vector2 region_size = rotated ? Vector2(region.size.y, region.size.x) : region.size;
+    if (region_size.x <= 0 || region_size.y <= 0) return Transform2D();
+    Vector2 k = content_size / region_size;
+    if (!rotated) {
+        return Transform2D(k.x, 0, 0, k.y, margin.position.x, margin.position.y);
+    }
+    // clockwise rotation: bitmap x follows region v, bitmap y runs against region u
+    return Transform2D(0, -k.y, k.x, 0, margin.position.x, margin.position.y + region.size.x * k.y);
 }
 
 
@@ -1435,7 +2187,8 @@ Ref<Resource> ResourceFormatLoaderFlashDocument::load(const String &p_path, cons
     Ref<FlashDocument> doc;
     doc.instantiate();
 
-    Error err = doc->load_file(p_path);
+    // imported documents are stored in the flat binary format
+    Error err = p_path.get_extension().to_lower() == "flashdoc" ? doc->load_binary(p_path) : doc->load_file(p_path);
     if (r_error) {
         *r_error = err;
     }
@@ -1452,6 +2205,7 @@ Ref<Resource> ResourceFormatLoaderFlashDocument::load(const String &p_path, cons
 
 void ResourceFormatLoaderFlashDocument::get_recognized_extensions(List<String> *p_extensions) const {
     p_extensions->push_back("zfl");
+    p_extensions->push_back("flashdoc");
 }
 
 bool ResourceFormatLoaderFlashDocument::handles_type(const String &p_type) const {
@@ -1460,7 +2214,7 @@ bool ResourceFormatLoaderFlashDocument::handles_type(const String &p_type) const
 
 String ResourceFormatLoaderFlashDocument::get_resource_type(const String &p_path) const {
     String extension = p_path.get_extension().to_lower();
-    if (extension == "zfl") {
+    if (extension == "zfl" || extension == "flashdoc") {
         return "FlashDocument";
     }
     return "";
@@ -26,10 +26,53 @@
 #include <core/io/resource.h>
 #include <core/io/xml_parser.h>
 #include <core/templates/list.h>
+#include <core/os/mutex.h>
+#include <core/templates/hash_map.h>
+#include <core/templates/local_vector.h>
+#include <core/templates/safe_refcount.h>
+#include <core/object/worker_thread_pool.h>
 #include <scene/resources/image_texture.h>
 #include <scene/resources/material.h>
 #include <scene/resources/compressed_texture.h>
 
+#include "flash_binary.h"
+
+struct FlashMaskItem {
+    Transform2D transform;
+    Rect2 texture_region;
+    int texture_idx;
+};
+
+class FlashLayer;
+
+// geometry range emitted by a layer with time independent content,
+// reused by the player while the evaluation inputs stay the same
+struct FlashLayerCacheEntry {
+    const FlashLayer *layer;
+    int keyframe;
+    float interpolation;
+    Transform2D transform;
+    Color add;
+    Color mult;
+    int clipping_offset;
+    int clipping_size;
+    int vertex_start;
+    int vertex_count;
+    int index_start;
+    int index_count;
+
+    inline bool matches(const FlashLayerCacheEntry &p_entry) const {
+        return layer == p_entry.layer
+            && keyframe == p_entry.keyframe
+            && interpolation == p_entry.interpolation
+            && transform == p_entry.transform
+            && add == p_entry.add
+            && mult == p_entry.mult
+            && clipping_offset == p_entry.clipping_offset
+            && clipping_size == p_entry.clipping_size;
+    }
+};
+
 #include "flash_player.h"
 
 class FlashPlayer;
@@ -37,7 +80,10 @@ class FlashDocument;
 class FlashTimeline;
 class FlashLayer;
 class FlashFrame;
+class FlashDrawing;
 class FlashTween;
+struct FlashBinaryWriter;
+struct FlashBinaryReader;
 
 struct FlashColorEffect {
     Color add;
@@ -66,6 +112,35 @@ struct FlashColorEffect {
     }
 };
 
+// geometry of a symbol evaluated at an integer frame, ready to be copied into FlashPlayer
+struct FlashBakedFrame {
+    bool valid;
+    Vector<Vector2> points;
+    Vector<Vector2> uvs;
+    Vector<Color> colors;
+    Vector<int> indices;
+    Vector<FlashMaskItem> clipping;
+
+    FlashBakedFrame(): valid(false) {}
+};
+
+// clips of a track interned at setup, players keep per track state in flat arrays
+struct FlashClipTrack {
+    String name;
+    Vector<String> clips;
+    Vector<Vector2> ranges;
+    HashMap<String, int> clip_ids;
+};
+
+// variant options interned at setup, every option lists
+// (variation_idx, frame) overrides it applies
+struct FlashVariantSlot {
+    String name;
+    Vector<String> options;
+    Vector<Vector<Vector2i>> overrides;
+    HashMap<String, int> option_ids;
+};
+
 class FlashElement: public Resource {
     GDCLASS(FlashElement, Resource);
 
@@ -103,8 +178,14 @@ class FlashTextureRect: public Resource {
 
     int index;
     Rect2 region;
+    // trimmed borders in original size units, position is the top left offset
+    // and size is the total trimmed width and height (same as AtlasTexture)
     Rect2 margin;
     Vector2 original_size;
+    // region holds the bitmap rotated 90 degrees clockwise
+    bool rotated;
+    // convex outline of opaque pixels in region local pixels, empty to draw the whole region
+    Vector<Vector2> polygon;
 
     static void _bind_methods();
 
@@ -113,7 +194,8 @@ public:
         index(0),
         region(Rect2()),
         margin(Rect2()),
-        original_size(Vector2()){}
+        original_size(Vector2()),
+        rotated(false){}
 
 	void set_index(const int p_index) { index = p_index; }
 	int get_index() const { return index; }
@@ -123,6 +205,22 @@ public:
 	Rect2 get_margin() const { return margin; }
     void set_original_size(const Vector2 &p_original_size) { original_size = p_original_size; }
 	Vector2 get_original_size() const { return original_size; }
+    void set_rotated(bool p_rotated) { rotated = p_rotated; }
+    bool is_rotated() const { return rotated; }
+    void set_polygon(const Vector<Vector2> &p_polygon) { polygon = p_polygon; }
+    Vector<Vector2> get_polygon() const { return polygon; }
+    Transform2D get_region_transform() const;
+
+    // polygons with more points are ignored and drawn as region quads
+    static const int MAX_POLYGON_POINTS = 32;
+};
+
+// what an element record of a binary document resolves to,
+// filled when the symbol owning the element is set up
+struct FlashBinaryTarget {
+    FlashTimeline *timeline;
+    FlashTextureRect *texture;
+    int loop_mode;
 };
 
 class FlashDocument: public FlashElement {
@@ -133,18 +231,56 @@ class FlashDocument: public FlashElement {
     Dictionary bitmaps;
     float frame_size;
     List <Ref<FlashTimeline>> timelines;
-    int last_eid;
+    SafeNumeric<int> last_eid;
     Ref<CompressedTexture2DArray> atlas;
+    RID material;
     Dictionary variants;
     int variated_symbols_count;
+    Vector<FlashClipTrack> clip_tracks;
+    HashMap<String, int> clip_track_ids;
+    Vector<FlashVariantSlot> variant_slots;
+    HashMap<String, int> variant_slot_ids;
+    bool bake_frames;
+    bool bake_interpolation;
+
+    // binary documents keep the file in memory and evaluate elements straight
+    // from its records, lazy ones also set their symbols up on first use
+    bool lazy_symbols;
+    Vector<uint8_t> binary_data;
+    Vector<String> binary_strings;
+    const FlashBinaryElement *binary_elements;
+    const int32_t *binary_element_refs;
+    LocalVector<FlashBinaryTarget> binary_targets;
+    Mutex symbols_mutex;
+    Vector<WorkerThreadPool::TaskID> prefetch_tasks;
+
+    // symbol files referenced by the document, parsed after it in parallel
+    Vector<String> includes;
+    // in-memory document files used instead of the file system while importing
+    const HashMap<String, Vector<uint8_t>> *source_files;
 
     static String invalid_character;
 
+    void _parse_timeline_task(uint32_t p_index, Ref<FlashTimeline> *r_timelines);
+    void _renumber_timeline(FlashTimeline *p_timeline);
+    void _renumber_drawing(FlashDrawing *p_drawing);
+    void _prefetch_task(PackedStringArray p_tokens);
+    void _collect_prefetch_tasks(bool p_wait);
+    bool _get_binary_reader(FlashBinaryReader &r_reader) const;
+    void _resolve_binary_element(int32_t p_element, const FlashBinaryReader &p_reader);
+
 public:
     FlashDocument():
         document_path(""),
         frame_size(1.0/24.0),
-        last_eid(0){}
+        last_eid(0),
+        bake_frames(false),
+        bake_interpolation(false),
+        lazy_symbols(false),
+        binary_elements(nullptr),
+        binary_element_refs(nullptr),
+        source_files(nullptr){}
+    ~FlashDocument();
 
     static void _bind_methods();
 
@@ -153,10 +289,15 @@ public:
 
     static Ref<FlashDocument> from_file(const String &p_path);
     Error load_file(const String &path);
+    Error load_files(const String &p_document_path, const HashMap<String, Vector<uint8_t>> &p_files);
+    Error open_xml(Ref<XMLParser> p_xml, const String &p_path) const;
+    Error load_binary(const String &p_path);
+    Error save_binary(const String &p_path);
 
     Vector2 get_atlas_size() const;
     Ref<CompressedTexture2DArray> get_atlas() const { return atlas; }
-    void set_atlas(Ref<CompressedTexture2DArray> p_atlas) { atlas = p_atlas; }
+    void set_atlas(Ref<CompressedTexture2DArray> p_atlas);
+    RID get_material();
     String get_document_path() const { return document_path; }
     Dictionary get_symbols() const { return symbols; }
     void set_symbols(Dictionary p_symbols) { symbols = p_symbols; }
@@ -169,10 +310,47 @@ public:
     float get_duration(String timeline = String(), String label = String());
     Dictionary get_variants() const;
     void cache_variants();
+    void cache_clips();
+    void cache_static();
     int get_variated_symbols_count() const { return variated_symbols_count; }
+    int get_clip_tracks_count() const { return clip_tracks.size(); }
+    const FlashClipTrack &get_clip_track(int p_idx) const { return clip_tracks[p_idx]; }
+    int find_clip_track(const String &p_track) const;
+    int find_clip(int p_track, const String &p_clip) const;
+    int get_variant_slots_count() const { return variant_slots.size(); }
+    const FlashVariantSlot &get_variant_slot(int p_idx) const { return variant_slots[p_idx]; }
+    int find_variant_slot(const String &p_variant) const;
+    bool is_bake_frames() const { return bake_frames; }
+    void set_bake_frames(bool p_bake_frames);
+    bool is_bake_interpolation() const { return bake_interpolation; }
+    void set_bake_interpolation(bool p_bake_interpolation) { bake_interpolation = p_bake_interpolation; }
+    void clear_baked_frames();
+
+    bool is_lazy_symbols() const { return lazy_symbols; }
+    void set_lazy_symbols(bool p_lazy_symbols) { lazy_symbols = p_lazy_symbols; }
+    // recursive, guards symbol loading and the static, bakeable and bounds memos
+    Mutex &get_symbols_mutex() { return symbols_mutex; }
+    void load_symbol(FlashTimeline *p_timeline);
+    bool evict_symbol(FlashTimeline *p_timeline);
+    bool evict_symbol_by_token(const String &p_token);
+    int evict_unused_symbols(int p_frames = 1);
+    int get_loaded_symbols_count() const;
+    void prefetch_symbols(const PackedStringArray &p_tokens);
+    bool is_prefetching();
+    void wait_for_prefetch();
+
+    void setup_binary_frame(FlashFrame *p_frame);
+    void read_binary_elements(const FlashFrame *p_frame, List<Ref<FlashDrawing>> *r_elements) const;
+    Transform2D get_binary_transform(int32_t p_element) const;
+    bool is_binary_element_bakeable(int32_t p_element);
+    bool is_binary_element_static(int32_t p_element);
+    bool get_binary_element_bounds(int32_t p_element, Rect2 &r_bounds);
+    void binary_element_process(int32_t p_element, FlashPlayer* node, float time, float delta, const Transform2D &tr, const FlashColorEffect &effect);
 
     FlashTimeline* get_timeline(String token);
-    void parse_timeline(const String &path);
+    FlashTimeline* find_symbol(const String &p_token) const;
+    Ref<FlashTimeline> parse_timeline(const String &path);
+    void parse_timelines();
     Ref<FlashTextureRect> get_bitmap_rect(const String &bitmap_name);
     inline float get_frame_size() const { return frame_size; }
     Ref<FlashTimeline> get_main_timeline();
@@ -185,6 +363,7 @@ public:
 
 class FlashBitmapItem: public FlashElement {
     GDCLASS(FlashBitmapItem, FlashElement);
+    friend FlashDocument;
     String name;
     String bitmap_path;
     Ref<FlashTextureRect> texture;
@@ -208,6 +387,8 @@ public:
 class FlashTimeline: public FlashElement {
     GDCLASS(FlashTimeline, FlashElement);
     friend FlashDocument;
+    friend FlashBinaryWriter;
+    friend FlashBinaryReader;
 
     String token;
     String local_path;
@@ -220,12 +401,46 @@ class FlashTimeline: public FlashElement {
     List<Ref<FlashLayer>> masks;
     int variation_idx;
 
+    // compiled at setup
+    int clip_track_idx;
+    Vector<FlashLayer*> layer_table;
+    Vector<FlashLayer*> mask_table;
+
+    // filled lazily by players when document baking is enabled,
+    // players may bake from worker threads
+    Vector<FlashBakedFrame> baked_frames;
+    mutable Mutex baked_mutex;
+    // memos are -1 unknown, MEMO_COMPUTING while the symbols mutex
+    // holder computes them, then 0 or 1
+    SafeNumeric<int> bakeable;
+    SafeNumeric<int> static_tree;
+    // conservative local bounds of every frame including tween overshoot,
+    // -1 unknown, 0 computing, 1 valid, 2 empty
+    SafeNumeric<int> bounds_state;
+    Rect2 bounds;
+
+    // cleared for symbols of lazy documents until their content is read,
+    // guarded by the document symbols mutex
+    SafeFlag loaded;
+    bool loading;
+    SafeNumeric<uint64_t> last_used;
+
+    static const int MEMO_COMPUTING = -2;
+    bool _compute_bakeable();
+    bool _compute_static();
+    bool _compute_bounds(Rect2 &r_bounds);
+
 public:
     FlashTimeline():
 
         token(""),
         duration(0),
-        variation_idx(-1){}
+        variation_idx(-1),
+        clip_track_idx(-1),
+        bakeable(-1),
+        static_tree(-1),
+        bounds_state(-1),
+        loading(false){ loaded.set(); }
 
     static void _bind_methods();
 
@@ -247,17 +462,35 @@ public:
     void set_layers(Array p_layers);
     int get_variation_idx() const { return variation_idx; }
     void set_variation_idx(int p_variation_idx) { variation_idx = p_variation_idx; }
+    int get_clip_track_idx() const { return clip_track_idx; }
+    bool is_loaded() const { return loaded.is_set(); }
+    uint64_t get_last_used() const { return last_used.get(); }
+    void ensure_loaded();
 
     Ref<FlashLayer> get_layer(int idx);
     void add_label(const String &label_name, const String &label_type, float start, float label_duration);
+
+    bool is_bakeable();
+    bool is_static();
+    void cache_static();
+    bool get_bounds(Rect2 &r_bounds);
+    Rect2 get_bounds_rect();
+    bool get_baked_frame(int p_frame, FlashBakedFrame &r_baked) const;
+    void set_baked_frame(int p_frame, const FlashBakedFrame &p_baked);
+    void clear_baked_frames();
+
     virtual void setup(FlashDocument *p_document, FlashElement *p_parent);
     virtual Error parse(Ref<XMLParser> xml);
+    void process_events(FlashPlayer* node, float time, float delta);
     void animation_process(FlashPlayer* node, float time, float delta, Transform2D tr=Transform2D(), FlashColorEffect effect=FlashColorEffect());
 };
 
 class FlashLayer: public FlashElement {
     GDCLASS(FlashLayer, FlashElement);
     friend FlashDocument;
+    friend FlashBinaryWriter;
+    friend FlashBinaryReader;
+    friend FlashTimeline;
     friend FlashFrame;
 
     int index;
@@ -268,6 +501,12 @@ class FlashLayer: public FlashElement {
     Color color;
     List<Ref<FlashFrame>> frames;
 
+    // compiled at setup: frame index -> index in `keyframes`, -1 before first keyframe
+    bool skip_processing;
+    bool is_mask;
+    Vector<FlashFrame*> keyframes;
+    Vector<int> frame_table;
+
 public:
     FlashLayer():
         index(0),
@@ -275,7 +514,9 @@ public:
         type(""),
         duration(0),
         mask_id(0),
-        color(Color()){}
+        color(Color()),
+        skip_processing(false),
+        is_mask(false){}
 
     static void _bind_methods();
 
@@ -291,6 +532,7 @@ public:
     void set_mask_id(int p_mask_id) { mask_id = p_mask_id; }
     Array get_frames();
     void set_frames(Array p_frames);
+    int get_keyframe_idx(int p_frame) const;
 
     virtual void setup(FlashDocument *p_document, FlashElement *p_parent);
     virtual Error parse(Ref<XMLParser> xml);
@@ -309,12 +551,20 @@ public:
     static void _bind_methods();
     Transform2D get_transform() const { return transform; }
     void set_transform(Transform2D p_transform) { transform = p_transform; }
+    virtual bool is_bakeable() { return true; }
+    // true when the emitted geometry does not depend on time
+    virtual bool is_static() { return true; }
+    // bounds of the emitted geometry before the element transform
+    virtual bool get_bounds(Rect2 &r_bounds) { return false; }
     virtual void animation_process(FlashPlayer* node, float time, float delta, Transform2D tr=Transform2D(), FlashColorEffect effect=FlashColorEffect());
 };
 
 class FlashFrame: public FlashElement {
     GDCLASS(FlashFrame, FlashElement);
     friend FlashDocument;
+    friend FlashBinaryWriter;
+    friend FlashBinaryReader;
+    friend FlashTimeline;
     friend FlashLayer;
 
     int index;
@@ -327,6 +577,18 @@ class FlashFrame: public FlashElement {
 
     List<Ref<FlashDrawing>> elements;
     List<Ref<FlashTween>> tweens;
+    // frame record of binary documents, its elements are
+    // evaluated in place instead of being read into `elements`
+    int binary_frame;
+
+    // compiled at setup, elements are either `element_table`
+    // entries or element records listed by `binary_refs`
+    FlashTween *tween;
+    Vector<FlashDrawing*> element_table;
+    const int32_t *binary_refs;
+    int elements_count;
+    Vector<FlashColorEffect> element_effects;
+    SafeNumeric<int> static_elements;
 
 public:
     FlashFrame():
@@ -335,7 +597,12 @@ public:
         frame_name(""),
         label_type(""),
         keymode(""),
-        tween_type("none"){}
+        tween_type("none"),
+        binary_frame(-1),
+        tween(nullptr),
+        binary_refs(nullptr),
+        elements_count(0),
+        static_elements(-1){}
 
     static void _bind_methods();
 
@@ -357,6 +624,14 @@ public:
     void set_elements(Array p_elements);
     Array get_tweens();
     void set_tweens(Array p_tweens);
+    bool has_static_elements();
+
+    int get_elements_count() const { return elements_count; }
+    Transform2D get_element_transform(int p_idx) const;
+    bool is_element_bakeable(int p_idx);
+    bool is_element_static(int p_idx);
+    bool get_element_bounds(int p_idx, Rect2 &r_bounds);
+    void element_process(int p_idx, FlashPlayer* node, float time, float delta, const Transform2D &tr, const FlashColorEffect &effect);
 
     virtual void setup(FlashDocument *p_document, FlashElement *p_parent);
     virtual Error parse(Ref<XMLParser> xml);
@@ -367,6 +642,14 @@ public:
 
 class FlashInstance: public FlashDrawing {
     GDCLASS(FlashInstance, FlashDrawing);
+    friend FlashBinaryWriter;
+    friend FlashBinaryReader;
+
+    enum LoopMode {
+        LOOP,
+        PLAY_ONCE,
+        SINGLE_FRAME
+    };
 
     Vector2 center_point;
     Vector2 transformation_point;
@@ -374,6 +657,7 @@ class FlashInstance: public FlashDrawing {
     String loop;
     String timeline_token;
     String layer_name;
+    LoopMode loop_mode;
 
     FlashTimeline* timeline;
 
@@ -387,6 +671,7 @@ public:
         loop("loop"),
         timeline_token(""),
         layer_name(""),
+        loop_mode(LOOP),
         timeline(nullptr),
         color_effect(FlashColorEffect()){}
 
@@ -395,15 +680,21 @@ public:
     int get_first_frame() const { return first_frame; }
     void set_first_frame(int p_first_frame) { first_frame = p_first_frame; }
     String get_loop() const { return loop; }
-    void set_loop(String p_loop) { loop = p_loop; }
+    void set_loop(String p_loop);
     PackedColorArray get_color_effect() const;
     void set_color_effect(PackedColorArray p_color_effect);
     String get_timeline_token() const { return timeline_token; }
     void set_timeline_token(String p_name) { timeline_token = p_name; }
     String get_layer_name() const { return layer_name; }
 
+    static int parse_loop_mode(const String &p_loop);
+    static void process_timeline(FlashPlayer* node, FlashTimeline *p_timeline, int p_loop_mode, int p_first_frame, float time, float delta, const Transform2D &tr, const FlashColorEffect &effect);
+
     virtual void setup(FlashDocument *p_document, FlashElement *p_parent);
     FlashTimeline* get_timeline();
+    virtual bool is_bakeable();
+    virtual bool is_static();
+    virtual bool get_bounds(Rect2 &r_bounds);
     virtual Error parse(Ref<XMLParser> xml);
     virtual void animation_process(FlashPlayer* node, float time, float delta, Transform2D tr=Transform2D(), FlashColorEffect effect=FlashColorEffect());
 };
@@ -418,8 +709,12 @@ public:
 
 class FlashGroup: public FlashDrawing {
     GDCLASS(FlashGroup, FlashDrawing);
+    friend FlashDocument;
+    friend FlashBinaryWriter;
+    friend FlashBinaryReader;
 
     List<Ref<FlashDrawing>> members;
+    Vector<FlashDrawing*> member_table;
 
 public:
     static void _bind_methods();
@@ -427,6 +722,9 @@ public:
     void set_members(Array p_members);
 
     List<Ref<FlashDrawing>> all_members() const;
+    virtual bool is_bakeable();
+    virtual bool is_static();
+    virtual bool get_bounds(Rect2 &r_bounds);
     virtual void setup(FlashDocument *p_document, FlashElement *p_parent);
     virtual Error parse(Ref<XMLParser> xml);
     virtual void animation_process(FlashPlayer* node, float time, float delta, Transform2D tr=Transform2D(), FlashColorEffect effect=FlashColorEffect());
@@ -438,7 +736,6 @@ class FlashBitmapInstance: public FlashDrawing {
 
     String library_item_name;
 
-    Vector<Vector2> uvs;
     Ref<FlashTextureRect> texture;
 
 public:
@@ -451,6 +748,11 @@ public:
     String get_library_item_name() const { return library_item_name; }
     void set_library_item_name(String p_library_item_name) { library_item_name = p_library_item_name; }
 
+    static bool get_texture_bounds(const FlashTextureRect *p_texture, Rect2 &r_bounds);
+    static void draw_texture(FlashPlayer* node, FlashDocument *p_document, const FlashTextureRect *p_texture, const Transform2D &tr, const FlashColorEffect &effect);
+
+    virtual bool get_bounds(Rect2 &r_bounds);
+    virtual void setup(FlashDocument *p_document, FlashElement *p_parent);
     Error parse(Ref<XMLParser> xml);
     virtual void animation_process(FlashPlayer* node, float time, float delta, Transform2D tr=Transform2D(), FlashColorEffect effect=FlashColorEffect());
 };
@@ -473,11 +775,18 @@ public:
         CUSTOM
     };
 
+    // easing is sampled at setup into LUT_SIZE + 1 values over [0, 1]
+    static const int LUT_SIZE = 64;
+
 private:
     String target;
     PackedVector2Array points;
     Method method;
     float intensity;
+    Vector<float> lut;
+
+    float evaluate(float time) const;
+    void build_lut();
 
 public:
 
@@ -491,15 +800,18 @@ public:
     String get_target() const { return target; }
     void set_target(String p_target) { target = p_target; }
     Method get_method() const { return method; }
-    void set_method(Method p_method) { method = p_method; }
+    void set_method(Method p_method) { method = p_method; lut.clear(); }
     float get_intensity() const { return intensity; }
-    void set_intensity(float p_intesity) { intensity = p_intesity; }
+    void set_intensity(float p_intesity) { intensity = p_intesity; lut.clear(); }
     PackedVector2Array get_points() const { return points; }
-    void set_points(PackedVector2Array p_points) { points = p_points; }
+    void set_points(PackedVector2Array p_points) { points = p_points; lut.clear(); }
 
+    virtual void setup(FlashDocument *p_document, FlashElement *p_parent);
     Error parse(Ref<XMLParser> xml);
 
-    float interpolate(float time);
+    float interpolate(float time) const;
+    void interpolate_batch(const float *p_times, float *r_values, int p_count) const;
+    void get_interpolation_range(float &r_min, float &r_max) const;
 };
 
 VARIANT_ENUM_CAST(FlashTween::Method);
@@ -24,7 +24,11 @@
 #include <core/object/class_db.h>
 #include <core/config/project_settings.h>
 #include "register_types.h"
+#include "core/config/engine.h"
 #include "flash_player.h"
+#include "flash_multi_player.h"
+#include "flash_player_server.h"
+#include "flash_benchmark.h"
 #include "flash_resources.h"
 #ifdef MODULE_FLASH_WITH_ANIMATION_NODES
 #include "animation_node_flash.h"
@@ -32,9 +36,9 @@
 
 // 声明资源加载器变量
 static Ref<ResourceFormatLoaderFlashDocument> resource_loader_flash_document;
+static FlashPlayerServer *flash_player_server = nullptr;
 
 #ifdef TOOLS_ENABLED
-#include "core/config/engine.h"
 #include "editor/export/editor_export.h"
 #include "editor/editor_node.h"
 #include "resource_importer_flash.h"
@@ -97,6 +101,9 @@ void initialize_flash_module(ModuleInitializationLevel p_level) {
     }
 	// core flash classes
 	ClassDB::register_class<FlashPlayer>();
+	ClassDB::register_class<FlashMultiPlayer>();
+	ClassDB::register_class<FlashPlayerServer>();
+	ClassDB::register_class<FlashBenchmark>();
 #ifdef MODULE_FLASH_WITH_ANIMATION_NODES
 	ClassDB::register_class<FlashMachine>();
 	ClassDB::register_class<AnimationNodeFlashClip>();
@@ -117,6 +124,10 @@ void initialize_flash_module(ModuleInitializationLevel p_level) {
 	ClassDB::register_class<FlashBitmapInstance>();
 	ClassDB::register_class<FlashTween>();
 
+	// batch evaluation server
+	flash_player_server = memnew(FlashPlayerServer);
+	Engine::get_singleton()->add_singleton(Engine::Singleton("FlashPlayerServer", FlashPlayerServer::get_singleton()));
+
 // 创建并注册资源加载器
     resource_loader_flash_document.instantiate();
     ResourceLoader::add_resource_format_loader(resource_loader_flash_document);
@@ -134,6 +145,12 @@ if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
         return;
     }
 
+    if (flash_player_server) {
+        Engine::get_singleton()->remove_singleton("FlashPlayerServer");
+        memdelete(flash_player_server);
+        flash_player_server = nullptr;
+    }
+
     // 移除资源加载器
     if (resource_loader_flash_document.is_valid()) {
         ResourceLoader::remove_resource_format_loader(resource_loader_flash_document);
@@ -26,6 +26,7 @@
 #include <core/io/image_loader.h>
 #include <core/io/resource_importer.h>
 #include <core/io/zip_io.h>
+#include <core/object/worker_thread_pool.h>
 #include <core/math/geometry_2d.h>
 #include <core/io/json.h>
 #include <core/io/marshalls.h>
@@ -38,7 +39,71 @@
 #include "resource_importer_flash.h"
 #include "flash_resources.h"
 
-const int ResourceImporterFlash::importer_version = 12;
+const int ResourceImporterFlash::importer_version = 16;
+
+// transparent gap kept around every repacked bitmap
+static const int ATLAS_PADDING = 2;
+
+// skyline bottom-left packer used to fill one atlas layer
+struct FlashAtlasSkyline {
+    int size;
+    LocalVector<Vector3i> nodes; // x, y, width
+
+    FlashAtlasSkyline(int p_size = 0) {
+        size = p_size;
+        nodes.push_back(Vector3i(0, 0, p_size));
+    }
+
+    int fit(uint32_t p_index, int p_width, int p_height) const {
+        int x = nodes[p_index].x;
+        if (x + p_width > size) return -1;
+        int y = nodes[p_index].y;
+        int width_left = p_width;
+        for (uint32_t i=p_index; width_left > 0; i++) {
+            if (i >= nodes.size()) return -1;
+            y = MAX(y, nodes[i].y);
+            if (y + p_height > size) return -1;
+            width_left -= nodes[i].z;
+        }
+        return y;
+    }
+
+    bool insert(const Size2i &p_size, Point2i &r_position) {
+        int best_bottom = INT_MAX;
+        int best_width = INT_MAX;
+        int best_index = -1;
+        for (uint32_t i=0; i<nodes.size(); i++) {
+            int y = fit(i, p_size.x, p_size.y);
+            if (y < 0) continue;
+            if (y + p_size.y < best_bottom || (y + p_size.y == best_bottom && nodes[i].z < best_width)) {
+                best_bottom = y + p_size.y;
+                best_width = nodes[i].z;
+                best_index = i;
+                r_position = Point2i(nodes[i].x, y);
+            }
+        }
+        if (best_index < 0) return false;
+
+        nodes.insert(best_index, Vector3i(r_position.x, r_position.y + p_size.y, p_size.x));
+        for (uint32_t i=best_index+1; i<nodes.size(); i++) {
+            int shrink = nodes[i-1].x + nodes[i-1].z - nodes[i].x;
+            if (shrink <= 0) break;
+            nodes[i].x += shrink;
+            nodes[i].z -= shrink;
+            if (nodes[i].z > 0) break;
+            nodes.remove_at(i);
+            i--;
+        }
+        for (uint32_t i=0; i+1<nodes.size(); i++) {
+            if (nodes[i].y == nodes[i+1].y) {
+                nodes[i].z += nodes[i+1].z;
+                nodes.remove_at(i+1);
+                i--;
+            }
+        }
+        return true;
+    }
+};
 
 String ResourceImporterFlash::get_importer_name() const {
     return "flash";
@@ -54,7 +119,7 @@ void ResourceImporterFlash::get_recognized_extensions(List<String> *p_extensions
 }
 
 String ResourceImporterFlash::get_save_extension() const {
-	return "tres";
+	return "flashdoc";
 }
 
 String ResourceImporterFlash::get_resource_type() const {
@@ -70,6 +135,13 @@ void ResourceImporterFlash::get_import_options(const String &p_path, List<Resour
 
     r_options->push_back(ResourceImporter::ImportOption(PropertyInfo(Variant::INT, "process/downscale", PROPERTY_HINT_ENUM, "Disabled,x2,x4"), 0));
 	r_options->push_back(ResourceImporter::ImportOption(PropertyInfo(Variant::BOOL, "process/fix_alpha_border"), true));
+	r_options->push_back(ResourceImporter::ImportOption(PropertyInfo(Variant::BOOL, "process/bake_frames"), false));
+	r_options->push_back(ResourceImporter::ImportOption(PropertyInfo(Variant::BOOL, "process/lazy_symbols"), false));
+	r_options->push_back(ResourceImporter::ImportOption(PropertyInfo(Variant::BOOL, "process/repack_atlas", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_UPDATE_ALL_IF_MODIFIED), false));
+	r_options->push_back(ResourceImporter::ImportOption(PropertyInfo(Variant::BOOL, "process/allow_rotation"), false));
+	r_options->push_back(ResourceImporter::ImportOption(PropertyInfo(Variant::INT, "process/max_atlas_size", PROPERTY_HINT_ENUM, "1024:1024,2048:2048,4096:4096,8192:8192"), 4096));
+	r_options->push_back(ResourceImporter::ImportOption(PropertyInfo(Variant::BOOL, "process/tight_polygons", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_UPDATE_ALL_IF_MODIFIED), false));
+	r_options->push_back(ResourceImporter::ImportOption(PropertyInfo(Variant::INT, "process/polygon_vertices", PROPERTY_HINT_RANGE, "3," + itos(FlashTextureRect::MAX_POLYGON_POINTS) + ",1"), 8));
 	r_options->push_back(ResourceImporter::ImportOption(PropertyInfo(Variant::INT, "compress/mode", PROPERTY_HINT_ENUM, "Lossless (PNG),Video RAM (S3TC/ETC/BPTC),Uncompressed", PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_UPDATE_ALL_IF_MODIFIED), 1));
 	r_options->push_back(ResourceImporter::ImportOption(PropertyInfo(Variant::INT, "flags/repeat", PROPERTY_HINT_ENUM, "Disabled,Enabled,Mirrored"), 0));
 	r_options->push_back(ResourceImporter::ImportOption(PropertyInfo(Variant::BOOL, "flags/filter"), true));
@@ -78,6 +150,12 @@ void ResourceImporterFlash::get_import_options(const String &p_path, List<Resour
 }
 
 bool ResourceImporterFlash::get_option_visibility(const String &p_path, const String &p_option, const HashMap<StringName, Variant> &p_options) const {
+    if (p_option == "process/allow_rotation" || p_option == "process/max_atlas_size") {
+        return p_options.has("process/repack_atlas") && (bool)p_options["process/repack_atlas"];
+    }
+    if (p_option == "process/polygon_vertices") {
+        return p_options.has("process/tight_polygons") && (bool)p_options["process/tight_polygons"];
+    }
     return true;
 }
 
@@ -132,6 +210,13 @@ Error ResourceImporterFlash::import(const String &p_source_file, const String &p
 	int srgb = p_options["flags/srgb"];
     int downscale = p_options["process/downscale"];
     bool fix_alpha_border = p_options["process/fix_alpha_border"];
+    bool bake_frames = p_options.has("process/bake_frames") ? (bool)p_options["process/bake_frames"] : false;
+    bool lazy_symbols = p_options.has("process/lazy_symbols") ? (bool)p_options["process/lazy_symbols"] : false;
+    bool repack_atlas = p_options.has("process/repack_atlas") ? (bool)p_options["process/repack_atlas"] : false;
+    bool allow_rotation = p_options.has("process/allow_rotation") ? (bool)p_options["process/allow_rotation"] : false;
+    int max_atlas_size = p_options.has("process/max_atlas_size") ? (int)p_options["process/max_atlas_size"] : 4096;
+    bool tight_polygons = p_options.has("process/tight_polygons") ? (bool)p_options["process/tight_polygons"] : false;
+    int polygon_vertices = p_options.has("process/polygon_vertices") ? (int)p_options["process/polygon_vertices"] : 8;
     bool high_quality = true;//p_options["compress/high_quality"];
     // int32_t tex_flags = ImageFormatLoader::FLAG_NONE;
 	// if (repeat > 0)
@@ -145,22 +230,19 @@ Error ResourceImporterFlash::import(const String &p_source_file, const String &p
 	// if (srgb == 1)
 	// 	tex_flags |= ImageFormatLoader::FLAG_FORCE_LINEAR;
 
-    // read zip and extract it to tmp dir
-    //const Vector2 PADDING(1, 1);
+    // read zip entries into memory, entries are decompressed by several workers
     Ref<FileAccess> zip_source_file;
-    // zlib_filefunc_def io = zipio_open(&zip_source_file);
     zlib_filefunc_def io = zipio_create_io(&zip_source_file);
     zipFile zip_source = unzOpen2(p_source_file.utf8().get_data(), &io);
     if (zip_source == NULL) return FAILED;
 
-    Ref<DirAccess> da = DirAccess::create(DirAccess::ACCESS_RESOURCES);
-    String tmp_dir = p_save_path + ".tmp/";
-    da->make_dir_recursive(tmp_dir);
-
     if (unzGoToFirstFile(zip_source) != UNZ_OK) {
+        unzClose(zip_source);
 		return FAILED;
 	}
 
+    ZipJob zip_job;
+    zip_job.source_file = p_source_file;
     String document_path = "";
     do {
         char char_filename[1024];
@@ -168,34 +250,42 @@ Error ResourceImporterFlash::import(const String &p_source_file, const String &p
 		unzGetCurrentFileInfo(zip_source, &info, char_filename, sizeof(char_filename), NULL, 0, NULL, 0);
         String file_name = String::utf8(char_filename);
         if (file_name.ends_with("/")) continue;
-        PackedByteArray data;
-        data.resize(info.uncompressed_size);
-        if (unzOpenCurrentFile(zip_source) != UNZ_OK) {
-		    ERR_FAIL_V_MSG(FAILED, "Could not open file within zip archive.");
-	    }
-        unzReadCurrentFile(zip_source, data.ptrw(), info.uncompressed_size);
-        String file_path = tmp_dir + file_name;
-        da->make_dir_recursive(file_path.get_base_dir());
-        Ref<FileAccess> file = FileAccess::open(file_path, FileAccess::WRITE);
-        file->store_buffer(data.ptr(), data.size());
-        file->close();
-        unzCloseCurrentFile(zip_source);
+        ZipEntry entry;
+        entry.name = file_name;
+        entry.size = info.uncompressed_size;
+        unzGetFilePos(zip_source, &entry.pos);
+        zip_job.entries.push_back(entry);
         if (document_path == String() && file_name.get_file() == "DOMDocument.xml"){
-            document_path = tmp_dir + file_name;
+            document_path = file_name;
         }
     } while (unzGoToNextFile(zip_source) == UNZ_OK);
+    unzClose(zip_source);
     if (document_path == "") {
-        da->remove(tmp_dir);
         return FAILED;
     }
 
+    zip_job.data.resize(zip_job.entries.size());
+    zip_job.workers = CLAMP(WorkerThreadPool::get_singleton()->get_thread_count(), 1, MAX(zip_job.entries.size(), 1));
+    WorkerThreadPool::GroupID unzip_group = WorkerThreadPool::get_singleton()->add_template_group_task(
+        this, &ResourceImporterFlash::_unzip_task, &zip_job, zip_job.workers, -1, true, SNAME("FlashImportUnzip")
+    );
+    WorkerThreadPool::get_singleton()->wait_for_group_task_completion(unzip_group);
+    ERR_FAIL_COND_V_MSG(zip_job.failed.is_set(), FAILED, "Could not read file within zip archive " + p_source_file);
+
+    HashMap<String, Vector<uint8_t>> files;
+    for (int i=0; i<zip_job.entries.size(); i++) {
+        files[zip_job.entries[i].name] = zip_job.data[i];
+    }
+    zip_job.data.clear();
 
-    // parse document
-    Ref<FlashDocument> doc = FlashDocument::from_file(document_path);
-    if (!doc.is_valid()) {
-        da->remove(tmp_dir);
+
+    // parse document, symbols are parsed in parallel
+    Ref<FlashDocument> doc; doc.instantiate();
+    if (doc->load_files(document_path, files) != OK) {
         return FAILED;
     }
+    doc->set_bake_frames(bake_frames);
+    doc->set_lazy_symbols(lazy_symbols);
 
 
 
@@ -240,17 +330,24 @@ Error ResourceImporterFlash::import(const String &p_source_file, const String &p
     //     return imported;
     // }
 
-    String spritesheet_files_path = doc->get_document_path() + "/spritesheets.list";
-    Vector<String> spritesheet_files = FileAccess::get_file_as_string(spritesheet_files_path).split("\n");
+    String spritesheet_files_path = doc->get_document_path().path_join("spritesheets.list");
+    Vector<String> spritesheet_files;
+    if (files.has(spritesheet_files_path)) {
+        const Vector<uint8_t> &list = files[spritesheet_files_path];
+        spritesheet_files = String::utf8((const char *)list.ptr(), list.size()).split("\n");
+    }
     while (spritesheet_files.size() > 0 && spritesheet_files[spritesheet_files.size()-1] == String()) {
         spritesheet_files.remove_at(spritesheet_files.size()-1);
     }
 
-    Vector<Ref<Image>> spritesheet_images;
+    SpritesheetJob spritesheet_job;
+    spritesheet_job.downscale = downscale;
+    spritesheet_job.fix_alpha_border = fix_alpha_border;
     Dictionary spritesheets_layout;
     for (int i=0; i<spritesheet_files.size(); i++) {
-        String spriteheet_base_path = doc->get_document_path() + "/" + spritesheet_files[i];
-        String json_text = FileAccess::get_file_as_string(spriteheet_base_path + ".json");
+        String spriteheet_base_path = doc->get_document_path().path_join(spritesheet_files[i]);
+        const Vector<uint8_t> *json_data = files.getptr(spriteheet_base_path + ".json");
+        String json_text = json_data ? String::utf8((const char *)json_data->ptr(), json_data->size()) : String();
         Variant json_variant = JSON::parse_string(json_text);
         if (json_variant.get_type() != Variant::DICTIONARY) {
             print_line("ERROR: Failed to parse JSON file: " + spriteheet_base_path + ".json");
@@ -268,34 +365,29 @@ Error ResourceImporterFlash::import(const String &p_source_file, const String &p
             spritesheets_layout[(String)frames.get_key_at_index(j)] = frame_info;
         }
         String spriteheet_path = spriteheet_base_path + ".png";
-        Ref<Image> img;
-        img.instantiate();
-        Error err = img->load(spriteheet_path);
-        if (err != OK) {
-            print_line("ERROR: Failed to load image: " + spriteheet_path + ", error code: " + String::num_int64(err));
-            continue;
-        }
-        if (img->is_empty()) {
-            print_line("ERROR: Loaded image is empty: " + spriteheet_path);
-            continue;
-        }
-        if (img->get_format() != Image::FORMAT_RGBA8) {
-            img->convert(Image::FORMAT_RGBA8);
-        }
-        if (fix_alpha_border) {
-            img->fix_alpha_edges();
-        }
-        for (int j=0; j<downscale; j++) {
-            img->shrink_x2();
-            if (fix_alpha_border) {
-                img->fix_alpha_edges();
-            }
+        const Vector<uint8_t> *png_data = files.getptr(spriteheet_path);
+        spritesheet_job.paths.push_back(spriteheet_path);
+        spritesheet_job.sources.push_back(png_data ? *png_data : Vector<uint8_t>());
+    }
+
+    // decode and post-process spritesheets concurrently
+    spritesheet_job.images.resize(spritesheet_job.sources.size());
+    if (spritesheet_job.sources.size() > 0) {
+        WorkerThreadPool::GroupID spritesheet_group = WorkerThreadPool::get_singleton()->add_template_group_task(
+            this, &ResourceImporterFlash::_spritesheet_task, &spritesheet_job, spritesheet_job.sources.size(), -1, true, SNAME("FlashImportSpritesheets")
+        );
+        WorkerThreadPool::get_singleton()->wait_for_group_task_completion(spritesheet_group);
+    }
+    Vector<Ref<Image>> spritesheet_images;
+    for (int i=0; i<spritesheet_job.images.size(); i++) {
+        if (spritesheet_job.images[i].is_valid()) {
+            spritesheet_images.push_back(spritesheet_job.images[i]);
         }
-        //img->optimize_channels();
-        spritesheet_images.push_back(img);
     }
 
     Array items = doc->get_bitmaps().values();
+    Vector<AtlasSprite> sprites;
+    Vector<int> empty_items;
     for (int i=0; i<items.size(); i++){
         Ref<FlashBitmapItem> item = items[i];
         Dictionary frame_info = spritesheets_layout.get(item->get_name().replace_first("gdexp/", ""), Dictionary());
@@ -319,9 +411,61 @@ Error ResourceImporterFlash::import(const String &p_source_file, const String &p
         frame->set_index(frame_info["texture_idx"]);
         frame->set_original_size(original_size);
 
+        if (repack_atlas) {
+            int sheet = frame_info["texture_idx"];
+            Ref<Image> sheet_image = sheet >= 0 && sheet < spritesheet_job.images.size() ? spritesheet_job.images[sheet] : Ref<Image>();
+            AtlasSprite sprite;
+            sprite.item = i;
+            if (sheet_image.is_valid() && _trim_sprite(sheet_image, region, original_size, allow_rotation, sprite)) {
+                sprites.push_back(sprite);
+            } else {
+                empty_items.push_back(i);
+            }
+        }
+
         item->set_texture(frame);
     }
 
+    // trim, rotate and repack bitmaps into equally sized power of two layers
+    Vector<Ref<Image>> polygon_sources = spritesheet_job.images;
+    if (repack_atlas && sprites.size() > 0) {
+        Vector<Ref<Image>> layers = _pack_atlas(sprites, max_atlas_size, fix_alpha_border);
+        if (layers.size() > 0) {
+            for (int i=0; i<sprites.size(); i++) {
+                const AtlasSprite &sprite = sprites[i];
+                Ref<FlashBitmapItem> item = items[sprite.item];
+                Ref<FlashTextureRect> frame = item->get_texture();
+                frame->set_index(sprite.layer);
+                frame->set_region(Rect2(sprite.position, sprite.image->get_size()));
+                frame->set_margin(sprite.margin);
+                frame->set_rotated(sprite.rotated);
+            }
+            for (int i=0; i<empty_items.size(); i++) {
+                Ref<FlashBitmapItem> item = items[empty_items[i]];
+                Ref<FlashTextureRect> frame = item->get_texture();
+                frame->set_index(0);
+                frame->set_region(Rect2());
+                frame->set_margin(Rect2(Vector2(), frame->get_original_size()));
+            }
+            spritesheet_images = layers;
+            polygon_sources = layers;
+        } else {
+            WARN_PRINT("Flash bitmaps do not fit into " + itos(max_atlas_size) + " atlas layers, exported spritesheets are used as is: " + p_source_file);
+        }
+    }
+
+    // convex outlines of opaque pixels, drawn instead of full region quads
+    if (tight_polygons) {
+        for (int i=0; i<items.size(); i++) {
+            Ref<FlashBitmapItem> item = items[i];
+            Ref<FlashTextureRect> frame = item->get_texture();
+            if (frame.is_null()) continue;
+            int index = frame->get_index();
+            if (index < 0 || index >= polygon_sources.size() || polygon_sources[index].is_null()) continue;
+            frame->set_polygon(_build_polygon(polygon_sources[index], frame->get_region(), polygon_vertices));
+        }
+    }
+
     const bool can_s3tc_bptc = ResourceImporterTextureSettings::should_import_s3tc_bptc();
 	const bool can_etc2_astc = ResourceImporterTextureSettings::should_import_etc2_astc();
     String extension = get_save_extension();
@@ -340,7 +484,8 @@ Error ResourceImporterFlash::import(const String &p_source_file, const String &p
 			_save_tex(spritesheet_images, p_save_path + "." + image_compress_format + ".ctexarray", compress_mode, 0.95, image_compress_mode, Image::COMPRESS_SOURCE_GENERIC, Image::USED_CHANNELS_RGBA, mipmaps, true);
             Ref<CompressedTexture2DArray> atlas = ResourceLoader::load(p_save_path + "." + image_compress_format + ".ctexarray");
             doc->set_atlas(atlas);
-            ResourceSaver::save(doc, p_save_path + "." + image_compress_format + "." + extension);
+            Error save_err = doc->save_binary(p_save_path + "." + image_compress_format + "." + extension);
+            ERR_FAIL_COND_V_MSG(save_err != OK, save_err, "Can't save flash document: " + p_save_path + "." + image_compress_format + "." + extension);
 			r_platform_variants->push_back(image_compress_format);
 		}
         if (can_etc2_astc) {
@@ -356,14 +501,16 @@ Error ResourceImporterFlash::import(const String &p_source_file, const String &p
 			_save_tex(spritesheet_images, p_save_path + "." + image_compress_format + ".ctexarray", compress_mode, 0.95, image_compress_mode, Image::COMPRESS_SOURCE_GENERIC, Image::USED_CHANNELS_RGBA, mipmaps, true);
             Ref<CompressedTexture2DArray> atlas = ResourceLoader::load(p_save_path + "." + image_compress_format + ".ctexarray");
             doc->set_atlas(atlas);
-            ResourceSaver::save(doc, p_save_path + "." + image_compress_format + "." + extension);
+            Error save_err = doc->save_binary(p_save_path + "." + image_compress_format + "." + extension);
+            ERR_FAIL_COND_V_MSG(save_err != OK, save_err, "Can't save flash document: " + p_save_path + "." + image_compress_format + "." + extension);
 			r_platform_variants->push_back(image_compress_format);
 		}
 	} else {
         _save_tex(spritesheet_images, p_save_path + ".ctexarray", compress_mode, 0.95, Image::COMPRESS_S3TC /* IGNORED */, Image::COMPRESS_SOURCE_GENERIC,  Image::USED_CHANNELS_RGBA, mipmaps, false);
         Ref<CompressedTexture2DArray> atlas = ResourceLoader::load(p_save_path + ".ctexarray");
-            doc->set_atlas(atlas);
-        ResourceSaver::save(doc, p_save_path + "." + extension);
+        doc->set_atlas(atlas);
+        Error save_err = doc->save_binary(p_save_path + "." + extension);
+        ERR_FAIL_COND_V_MSG(save_err != OK, save_err, "Can't save flash document: " + p_save_path + "." + extension);
 	}
 
 	if (r_metadata) {
@@ -406,6 +553,227 @@ Error ResourceImporterFlash::import(const String &p_source_file, const String &p
     return OK;
 }
 
+void ResourceImporterFlash::_unzip_task(uint32_t p_worker, ZipJob *p_job) {
+    // every worker reads its own share of entries through a separate handle
+    Ref<FileAccess> zip_source_file;
+    zlib_filefunc_def io = zipio_create_io(&zip_source_file);
+    zipFile zip_source = unzOpen2(p_job->source_file.utf8().get_data(), &io);
+    if (zip_source == NULL) {
+        p_job->failed.set();
+        return;
+    }
+    for (uint32_t i=p_worker; i<(uint32_t)p_job->entries.size(); i+=p_job->workers) {
+        const ZipEntry &entry = p_job->entries[i];
+        unz_file_pos pos = entry.pos;
+        Vector<uint8_t> &data = p_job->data.write[i];
+        data.resize(entry.size);
+        if (unzGoToFilePos(zip_source, &pos) != UNZ_OK || unzOpenCurrentFile(zip_source) != UNZ_OK) {
+            p_job->failed.set();
+            break;
+        }
+        // short reads leave garbage in the entry, the whole import fails on them
+        int read = entry.size > 0 ? unzReadCurrentFile(zip_source, data.ptrw(), entry.size) : 0;
+        unzCloseCurrentFile(zip_source);
+        if (read != (int)entry.size) {
+            p_job->failed.set();
+            break;
+        }
+    }
+    unzClose(zip_source);
+}
+
+void ResourceImporterFlash::_spritesheet_task(uint32_t p_index, SpritesheetJob *p_job) {
+    const String &path = p_job->paths[p_index];
+    const Vector<uint8_t> &source = p_job->sources[p_index];
+    if (source.size() == 0) {
+        print_line("ERROR: Failed to load image: " + path + ", file not found");
+        return;
+    }
+    Ref<Image> img;
+    img.instantiate();
+    Error err = img->load_png_from_buffer(source);
+    if (err != OK) {
+        print_line("ERROR: Failed to load image: " + path + ", error code: " + String::num_int64(err));
+        return;
+    }
+    if (img->is_empty()) {
+        print_line("ERROR: Loaded image is empty: " + path);
+        return;
+    }
+    if (img->get_format() != Image::FORMAT_RGBA8) {
+        img->convert(Image::FORMAT_RGBA8);
+    }
+    if (p_job->fix_alpha_border) {
+        img->fix_alpha_edges();
+    }
+    for (int j=0; j<p_job->downscale; j++) {
+        img->shrink_x2();
+        if (p_job->fix_alpha_border) {
+            img->fix_alpha_edges();
+        }
+    }
+    //img->optimize_channels();
+    p_job->images.write[p_index] = img;
+}
+
+bool ResourceImporterFlash::_trim_sprite(const Ref<Image> &p_sheet, const Rect2 &p_region, const Vector2 &p_original_size, bool p_allow_rotation, AtlasSprite &r_sprite) const {
+    Point2i start = p_region.position.floor();
+    Rect2i source = Rect2i(start, Point2i((p_region.position + p_region.size).ceil()) - start);
+    source = source.intersection(Rect2i(Point2i(), p_sheet->get_size()));
+    if (source.size.x <= 0 || source.size.y <= 0) return false;
+
+    Ref<Image> image = p_sheet->get_region(source);
+    Rect2i used = image->get_used_rect();
+    if (used.size.x <= 0 || used.size.y <= 0) return false;
+    if (used.size != source.size) {
+        image = image->get_region(used);
+    }
+
+    // margins are stored in original size units, regions stay in atlas pixels
+    Vector2 pixel_size = p_original_size / Vector2(source.size);
+    r_sprite.margin = Rect2(Vector2(used.position) * pixel_size, Vector2(source.size - used.size) * pixel_size);
+    r_sprite.rotated = p_allow_rotation && used.size.y > used.size.x;
+    if (r_sprite.rotated) {
+        image->rotate_90(CLOCKWISE);
+    }
+    r_sprite.image = image;
+    return true;
+}
+
+int ResourceImporterFlash::_pack_layers(Vector<AtlasSprite> &r_sprites, const Vector<Vector3i> &p_order, int p_size, bool p_write) const {
+    LocalVector<FlashAtlasSkyline> layers;
+    for (int i=p_order.size()-1; i>=0; i--) {
+        AtlasSprite &sprite = r_sprites.write[p_order[i].z];
+        Size2i padded = sprite.image->get_size() + Size2i(ATLAS_PADDING, ATLAS_PADDING) * 2;
+        Point2i position;
+        int layer = -1;
+        for (uint32_t l=0; l<layers.size() && layer < 0; l++) {
+            if (layers[l].insert(padded, position)) layer = l;
+        }
+        if (layer < 0) {
+            layers.push_back(FlashAtlasSkyline(p_size));
+            layer = layers.size() - 1;
+            if (!layers[layer].insert(padded, position)) return -1;
+        }
+        if (p_write) {
+            sprite.layer = layer;
+            sprite.position = position + Point2i(ATLAS_PADDING, ATLAS_PADDING);
+        }
+    }
+    return layers.size();
+}
+
+Vector<Ref<Image>> ResourceImporterFlash::_pack_atlas(Vector<AtlasSprite> &r_sprites, int p_max_size, bool p_fix_alpha_border) const {
+    // tallest bitmaps go first, sorted ascending and walked backwards
+    Vector<Vector3i> order;
+    int min_size = 1;
+    for (int i=0; i<r_sprites.size(); i++) {
+        Size2i size = r_sprites[i].image->get_size();
+        order.push_back(Vector3i(size.y, size.x, i));
+        min_size = MAX(min_size, (int)next_power_of_2(MAX(size.x, size.y) + ATLAS_PADDING * 2));
+    }
+    order.sort();
+    if (min_size > p_max_size) return Vector<Ref<Image>>();
+
+    // the smallest layer size keeping the fewest layers
+    int best_size = p_max_size;
+    int best_layers = _pack_layers(r_sprites, order, best_size, false);
+    if (best_layers < 0) return Vector<Ref<Image>>();
+    for (int size=p_max_size/2; size>=min_size; size/=2) {
+        int layers_count = _pack_layers(r_sprites, order, size, false);
+        if (layers_count < 0 || layers_count > best_layers) break;
+        best_size = size;
+    }
+    best_layers = _pack_layers(r_sprites, order, best_size, true);
+
+    Vector<Ref<Image>> layers;
+    for (int i=0; i<best_layers; i++) {
+        layers.push_back(Image::create_empty(best_size, best_size, false, Image::FORMAT_RGBA8));
+    }
+    for (int i=0; i<r_sprites.size(); i++) {
+        const AtlasSprite &sprite = r_sprites[i];
+        layers.write[sprite.layer]->blit_rect(sprite.image, Rect2i(Point2i(), sprite.image->get_size()), sprite.position);
+    }
+    if (p_fix_alpha_border) {
+        for (int i=0; i<layers.size(); i++) {
+            layers.write[i]->fix_alpha_edges();
+        }
+    }
+    return layers;
+}
+
+Vector<Vector2> ResourceImporterFlash::_build_polygon(const Ref<Image> &p_image, const Rect2 &p_region, int p_max_points) const {
+    Point2i start = p_region.position.floor();
+    Rect2i source = Rect2i(start, Point2i((p_region.position + p_region.size).ceil()) - start);
+    source = source.intersection(Rect2i(Point2i(), p_image->get_size()));
+    if (source.size.x <= 0 || source.size.y <= 0) return Vector<Vector2>();
+
+    // outer corners of the leftmost and rightmost opaque pixel of every row,
+    // their hull covers every opaque pixel
+    Vector<Vector2> corners;
+    for (int y=source.position.y; y<source.position.y + source.size.y; y++) {
+        int left = -1;
+        int right = -1;
+        for (int x=source.position.x; x<source.position.x + source.size.x; x++) {
+            if (p_image->get_pixel(x, y).a <= 0) continue;
+            if (left < 0) left = x;
+            right = x;
+        }
+        if (left < 0) continue;
+        corners.push_back(Vector2(left, y));
+        corners.push_back(Vector2(left, y + 1));
+        corners.push_back(Vector2(right + 1, y));
+        corners.push_back(Vector2(right + 1, y + 1));
+    }
+    if (corners.size() == 0) return Vector<Vector2>();
+
+    Vector<Vector2> hull = Geometry2D::convex_hull(corners);
+    if (hull.size() > 1 && hull[0] == hull[hull.size() - 1]) {
+        hull.resize(hull.size() - 1);
+    }
+    for (int i=0; i<hull.size(); i++) {
+        hull.write[i] = (hull[i] - p_region.position).clamp(Vector2(), p_region.size);
+    }
+
+    // drop one edge at a time by extending its neighbours until they meet,
+    // the cut with the smallest added area is taken so the outline only grows
+    while (hull.size() > p_max_points) {
+        int count = hull.size();
+        int best_edge = -1;
+        real_t best_area = 0;
+        Vector2 best_point;
+        for (int i=0; i<count; i++) {
+            Vector2 prev = hull[(i + count - 1) % count];
+            Vector2 a = hull[i];
+            Vector2 b = hull[(i + 1) % count];
+            Vector2 next = hull[(i + 2) % count];
+            Vector2 point;
+            if (!Geometry2D::line_intersects_line(a, a - prev, b, b - next, point)) continue;
+            if ((point - a).dot(a - prev) < 0 || (point - b).dot(b - next) < 0) continue;
+            if (point.x < -CMP_EPSILON || point.y < -CMP_EPSILON || point.x > p_region.size.x + CMP_EPSILON || point.y > p_region.size.y + CMP_EPSILON) continue;
+            real_t area = Math::abs((a - point).cross(b - point)) * 0.5;
+            if (best_edge < 0 || area < best_area) {
+                best_edge = i;
+                best_area = area;
+                best_point = point.clamp(Vector2(), p_region.size);
+            }
+        }
+        if (best_edge < 0) return Vector<Vector2>();
+        hull.write[best_edge] = best_point;
+        hull.remove_at((best_edge + 1) % count);
+    }
+
+    // not worth the extra vertices when it saves little fill
+    real_t area = 0;
+    for (int i=0; i<hull.size(); i++) {
+        area += hull[i].cross(hull[(i + 1) % hull.size()]);
+    }
+    if (hull.size() < 3 || Math::abs(area) * 0.5 > p_region.size.x * p_region.size.y * 0.9) {
+        return Vector<Vector2>();
+    }
+    return hull;
+}
+
 void ResourceImporterFlash::_save_tex(Vector<Ref<Image>> p_images, const String &p_to_path, int p_compress_mode, float p_lossy, Image::CompressMode p_vram_compression, Image::CompressSource p_csource, Image::UsedChannels used_channels, bool p_mipmaps, bool p_force_po2) {
     Vector<Ref<Image>> mipmap_images; //for 3D
     for (int i = 0; i < p_images.size(); i++) {
@@ -23,6 +23,8 @@
 #ifndef RESOURCE_IMPORTER_FLASH_H
 #define RESOURCE_IMPORTER_FLASH_H
 
+#include <core/io/zip_io.h>
+#include <core/templates/safe_refcount.h>
 #include <editor/import/resource_importer_texture.h>
 
 class ResourceImporterFlash: public ResourceImporter {
@@ -32,6 +34,43 @@ class ResourceImporterFlash: public ResourceImporter {
 	static const char *compression_formats[];
 
 protected:
+	struct ZipEntry {
+		String name;
+		uint32_t size = 0;
+		unz_file_pos pos;
+	};
+
+	struct ZipJob {
+		String source_file;
+		Vector<ZipEntry> entries;
+		Vector<Vector<uint8_t>> data;
+		uint32_t workers = 1;
+		SafeFlag failed;
+	};
+
+	struct SpritesheetJob {
+		Vector<String> paths;
+		Vector<Vector<uint8_t>> sources;
+		Vector<Ref<Image>> images;
+		int downscale = 0;
+		bool fix_alpha_border = false;
+	};
+
+	struct AtlasSprite {
+		int item = -1;
+		Ref<Image> image;
+		Rect2 margin;
+		bool rotated = false;
+		int layer = -1;
+		Point2i position;
+	};
+
+	void _unzip_task(uint32_t p_worker, ZipJob *p_job);
+	void _spritesheet_task(uint32_t p_index, SpritesheetJob *p_job);
+	bool _trim_sprite(const Ref<Image> &p_sheet, const Rect2 &p_region, const Vector2 &p_original_size, bool p_allow_rotation, AtlasSprite &r_sprite) const;
+	int _pack_layers(Vector<AtlasSprite> &r_sprites, const Vector<Vector3i> &p_order, int p_size, bool p_write) const;
+	Vector<Ref<Image>> _pack_atlas(Vector<AtlasSprite> &r_sprites, int p_max_size, bool p_fix_alpha_border) const;
+	Vector<Vector2> _build_polygon(const Ref<Image> &p_image, const Rect2 &p_region, int p_max_points) const;
 	void _save_tex(
 		Vector<Ref<Image>> p_images,
 		const String &p_to_path,
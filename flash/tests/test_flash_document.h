@@ -0,0 +1,142 @@
+// MIT License
+
+// Copyright (c) 2021 Yakov Borevich, Funexpected LLC
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TEST_FLASH_DOCUMENT_H
+#define TEST_FLASH_DOCUMENT_H
+
+#include "core/os/os.h"
+#include "tests/test_macros.h"
+
+#include "../flash_resources.h"
+
+namespace TestFlashDocument {
+
+// single layer, single frame timeline, holding an instance of p_nested when given
+static Ref<FlashTimeline> make_timeline(const String &p_token, const String &p_nested, const Transform2D &p_transform = Transform2D()) {
+    Array elements;
+    if (p_nested != String()) {
+        Ref<FlashInstance> instance;
+        instance.instantiate();
+        instance->set_timeline_token(p_nested);
+        instance->set_loop("loop");
+        instance->set_transform(p_transform);
+        elements.push_back(instance);
+    }
+    Ref<FlashFrame> frame;
+    frame.instantiate();
+    frame->set_duration(1);
+    frame->set_elements(elements);
+
+    Array frames;
+    frames.push_back(frame);
+    Ref<FlashLayer> layer;
+    layer.instantiate();
+    layer->set_layer_name("layer");
+    layer->set_type("normal");
+    layer->set_duration(1);
+    layer->set_frames(frames);
+
+    Array layers;
+    layers.push_back(layer);
+    Ref<FlashTimeline> timeline;
+    timeline.instantiate();
+    timeline->set_token(p_token);
+    timeline->set_duration(1);
+    timeline->set_layers(layers);
+    return timeline;
+}
+
+// main -> outer -> inner, saved as a lazy binary document and loaded back
+static Ref<FlashDocument> make_binary_document(const String &p_name, const Transform2D &p_transform = Transform2D()) {
+    Dictionary symbols;
+    symbols["outer"] = make_timeline("outer", "inner", p_transform);
+    symbols["inner"] = make_timeline("inner", String());
+    Array timelines;
+    timelines.push_back(make_timeline("main", "outer", p_transform));
+
+    Ref<FlashDocument> source;
+    source.instantiate();
+    source->set_symbols(symbols);
+    source->set_timelines(timelines);
+    source->set_lazy_symbols(true);
+    String path = OS::get_singleton()->get_cache_path().path_join(p_name);
+    if (source->save_binary(path) != OK) {
+        return Ref<FlashDocument>();
+    }
+
+    Ref<FlashDocument> document;
+    document.instantiate();
+    if (document->load_binary(path) != OK) {
+        return Ref<FlashDocument>();
+    }
+    document->setup(document.ptr(), nullptr);
+    return document;
+}
+
+TEST_CASE("[SceneTree][Flash] Lazy binary documents load symbols on first use") {
+    Ref<FlashDocument> document = make_binary_document("test_flash_lazy.flashdoc");
+    REQUIRE(document.is_valid());
+    CHECK(document->is_lazy_symbols());
+    CHECK_MESSAGE(document->get_loaded_symbols_count() == 0, "Setting the document up must not load nested symbols.");
+
+    FlashTimeline *outer = document->get_timeline("outer");
+    REQUIRE(outer != nullptr);
+    CHECK(outer->is_loaded());
+    CHECK_MESSAGE(document->get_loaded_symbols_count() == 1, "Loading a symbol must not load the symbols it nests.");
+
+    // the static flag covers the whole tree, so the nested symbol is evaluated
+    CHECK(outer->is_static());
+    CHECK(document->get_loaded_symbols_count() == 2);
+
+    CHECK(document->evict_symbol_by_token("inner"));
+    CHECK(document->get_loaded_symbols_count() == 1);
+    CHECK(document->get_timeline("inner") != nullptr);
+    CHECK(document->get_loaded_symbols_count() == 2);
+}
+
+TEST_CASE("[SceneTree][Flash] Binary document elements round trip") {
+    Transform2D transform(0.5, Vector2(10, 20));
+    Ref<FlashDocument> document = make_binary_document("test_flash_elements.flashdoc", transform);
+    REQUIRE(document.is_valid());
+
+    FlashTimeline *outer = document->get_timeline("outer");
+    REQUIRE(outer != nullptr);
+    Array layers = outer->get_layers();
+    REQUIRE(layers.size() == 1);
+    Ref<FlashLayer> layer = layers[0];
+    Array frames = layer->get_frames();
+    REQUIRE(frames.size() == 1);
+    Ref<FlashFrame> frame = frames[0];
+    CHECK(frame->get_elements_count() == 1);
+    CHECK(frame->get_element_transform(0).is_equal_approx(transform));
+
+    Array elements = frame->get_elements();
+    REQUIRE(elements.size() == 1);
+    Ref<FlashInstance> instance = elements[0];
+    REQUIRE(instance.is_valid());
+    CHECK(instance->get_timeline_token() == "inner");
+    CHECK(instance->get_transform().is_equal_approx(transform));
+}
+
+} // namespace TestFlashDocument
+
+#endif // TEST_FLASH_DOCUMENT_H
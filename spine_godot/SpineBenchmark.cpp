@@ -0,0 +1,202 @@
+/******************************************************************************
+ * Spine Runtimes License Agreement
+ * Last updated April 5, 2025. Replaces all prior versions.
+ *
+ * Copyright (c) 2013-2025, Esoteric Software LLC
+ *
+ * Integration of the Spine Runtimes into software or otherwise creating
+ * derivative works of the Spine Runtimes is permitted under the terms and
+ * conditions of Section 2 of the Spine Editor License Agreement:
+ * http://esotericsoftware.com/spine-editor-license
+ *
+ * Otherwise, it is permitted to integrate the Spine Runtimes into software
+ * or otherwise create derivative works of the Spine Runtimes (collectively,
+ * "Products"), provided that each user of the Products must obtain their own
+ * Spine Editor license and redistribution of the Products in any form must
+ * include this license and copyright notice.
+ *
+ * THE SPINE RUNTIMES ARE PROVIDED BY ESOTERIC SOFTWARE LLC "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ESOTERIC SOFTWARE LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES,
+ * BUSINESS INTERRUPTION, OR LOSS OF USE, DATA, OR PROFITS) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THE SPINE RUNTIMES, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#include "SpineBenchmark.h"
+
+#if defined(SPINE_GODOT_EXTENSION) || VERSION_MAJOR > 3
+
+#include "SpinePerformance.h"
+#include "SpineSprite.h"
+
+#ifdef SPINE_GODOT_EXTENSION
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/json.hpp>
+#include <godot_cpp/classes/resource_loader.hpp>
+#else
+#include "core/config/engine.h"
+#include "core/io/json.h"
+#include "core/io/resource_loader.h"
+#endif
+
+void SpineBenchmark::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("run", "path"), &SpineBenchmark::run);
+	ClassDB::bind_method(D_METHOD("run_json", "path"), &SpineBenchmark::run_json);
+	ClassDB::bind_method(D_METHOD("set_sprites", "sprites"), &SpineBenchmark::set_sprites);
+	ClassDB::bind_method(D_METHOD("get_sprites"), &SpineBenchmark::get_sprites);
+	ClassDB::bind_method(D_METHOD("set_frames", "frames"), &SpineBenchmark::set_frames);
+	ClassDB::bind_method(D_METHOD("get_frames"), &SpineBenchmark::get_frames);
+	ClassDB::bind_method(D_METHOD("set_delta", "delta"), &SpineBenchmark::set_delta);
+	ClassDB::bind_method(D_METHOD("get_delta"), &SpineBenchmark::get_delta);
+	ClassDB::bind_method(D_METHOD("set_animation", "animation"), &SpineBenchmark::set_animation);
+	ClassDB::bind_method(D_METHOD("get_animation"), &SpineBenchmark::get_animation);
+	ClassDB::bind_method(D_METHOD("set_skin", "skin"), &SpineBenchmark::set_skin);
+	ClassDB::bind_method(D_METHOD("get_skin"), &SpineBenchmark::get_skin);
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "sprites"), "set_sprites", "get_sprites");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "frames"), "set_frames", "get_frames");
+	ADD_PROPERTY(PropertyInfo(VARIANT_FLOAT, "delta"), "set_delta", "get_delta");
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "animation"), "set_animation", "get_animation");
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "skin"), "set_skin", "get_skin");
+}
+
+SpineBenchmark::SpineBenchmark() : sprites(100), frames(300), delta(1.0f / 60.0f) {
+}
+
+void SpineBenchmark::set_sprites(int _sprites) {
+	sprites = MAX(_sprites, 1);
+}
+
+int SpineBenchmark::get_sprites() {
+	return sprites;
+}
+
+void SpineBenchmark::set_frames(int _frames) {
+	frames = MAX(_frames, 1);
+}
+
+int SpineBenchmark::get_frames() {
+	return frames;
+}
+
+void SpineBenchmark::set_delta(float _delta) {
+	delta = _delta;
+}
+
+float SpineBenchmark::get_delta() {
+	return delta;
+}
+
+void SpineBenchmark::set_animation(const String &_animation) {
+	animation = _animation;
+}
+
+String SpineBenchmark::get_animation() {
+	return animation;
+}
+
+void SpineBenchmark::set_skin(const String &_skin) {
+	skin = _skin;
+}
+
+String SpineBenchmark::get_skin() {
+	return skin;
+}
+
+Dictionary SpineBenchmark::run(const String &path) {
+	Dictionary result;
+
+	uint64_t start = SpinePerformance::get_ticks_usec();
+#ifdef SPINE_GODOT_EXTENSION
+	Ref<SpineSkeletonDataResource> skeleton_data = ResourceLoader::get_singleton()->load(path, "", ResourceLoader::CACHE_MODE_IGNORE_DEEP);
+#else
+	Ref<SpineSkeletonDataResource> skeleton_data = ResourceLoader::load(path, "", ResourceFormatLoader::CACHE_MODE_IGNORE_DEEP);
+#endif
+	uint64_t load_usec = SpinePerformance::get_ticks_usec() - start;
+	if (skeleton_data.is_null() || !skeleton_data->is_skeleton_data_loaded()) {
+		ERR_PRINT(String("Can't load skeleton data: ") + path);
+		return result;
+	}
+
+	String animation_name = animation;
+	if (EMPTY(animation_name)) {
+#ifdef SPINE_GODOT_EXTENSION
+		PackedStringArray animation_names;
+#else
+		Vector<String> animation_names;
+#endif
+		skeleton_data->get_animation_names(animation_names);
+		if (animation_names.size() > 0) animation_name = animation_names[0];
+	}
+
+	start = SpinePerformance::get_ticks_usec();
+	Vector<SpineSprite *> instances;
+	for (int i = 0; i < sprites; i++) {
+		SpineSprite *sprite = memnew(SpineSprite);
+		sprite->set_update_mode(SpineConstant::UpdateMode_Manual);
+		sprite->set_skeleton_data_res(skeleton_data);
+		if (!EMPTY(skin)) sprite->get_skeleton()->set_skin_by_name(skin);
+		if (!EMPTY(animation_name)) sprite->get_animation_state()->set_animation(animation_name, true, 0);
+		// Spread sprites over the animation, so they don't pose identically.
+		sprite->get_animation_state()->update(delta * i * 7);
+		instances.push_back(sprite);
+	}
+	uint64_t setup_usec = SpinePerformance::get_ticks_usec() - start;
+
+	// Same stages as SpineSprite::update_skeleton(), which bails out for sprites outside of the tree.
+	uint64_t animation_usec = 0;
+	uint64_t skeleton_usec = 0;
+	uint64_t mesh_usec = 0;
+	for (int f = 0; f < frames; f++) {
+		for (int i = 0; i < instances.size(); i++) {
+			SpineSprite *sprite = instances[i];
+			Ref<SpineSkeleton> skeleton = sprite->get_skeleton();
+			uint64_t t0 = SpinePerformance::get_ticks_usec();
+			sprite->get_animation_state()->update(delta);
+			sprite->get_animation_state()->apply(skeleton);
+			uint64_t t1 = SpinePerformance::get_ticks_usec();
+			skeleton->update(delta);
+			skeleton->update_world_transform();
+			uint64_t t2 = SpinePerformance::get_ticks_usec();
+			sprite->sort_slot_nodes();
+			sprite->update_meshes(skeleton);
+			uint64_t t3 = SpinePerformance::get_ticks_usec();
+			animation_usec += t1 - t0;
+			skeleton_usec += t2 - t1;
+			mesh_usec += t3 - t2;
+		}
+	}
+
+	for (int i = 0; i < instances.size(); i++) {
+		memdelete(instances[i]);
+	}
+
+	Dictionary stages;
+	stages["load_ms"] = load_usec / 1000.0;
+	stages["setup_ms"] = setup_usec / 1000.0;
+	stages["animation_ms"] = animation_usec / 1000.0;
+	stages["skeleton_ms"] = skeleton_usec / 1000.0;
+	// Includes clipping, SpineSprite::update_meshes() clips while building.
+	stages["mesh_build_ms"] = mesh_usec / 1000.0;
+
+	result["runtime"] = "spine";
+	result["engine_version"] = Engine::get_singleton()->get_version_info()["string"];
+	result["path"] = path;
+	result["animation"] = animation_name;
+	result["sprites"] = sprites;
+	result["frames"] = frames;
+	result["stages"] = stages;
+	result["frame_ms"] = (animation_usec + skeleton_usec + mesh_usec) / 1000.0 / frames;
+	return result;
+}
+
+String SpineBenchmark::run_json(const String &path) {
+	return JSON::stringify(run(path), "\t", false);
+}
+
+#endif
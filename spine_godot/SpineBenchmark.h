@@ -0,0 +1,86 @@
+/******************************************************************************
+ * Spine Runtimes License Agreement
+ * Last updated April 5, 2025. Replaces all prior versions.
+ *
+ * Copyright (c) 2013-2025, Esoteric Software LLC
+ *
+ * Integration of the Spine Runtimes into software or otherwise creating
+ * derivative works of the Spine Runtimes is permitted under the terms and
+ * conditions of Section 2 of the Spine Editor License Agreement:
+ * http://esotericsoftware.com/spine-editor-license
+ *
+ * Otherwise, it is permitted to integrate the Spine Runtimes into software
+ * or otherwise create derivative works of the Spine Runtimes (collectively,
+ * "Products"), provided that each user of the Products must obtain their own
+ * Spine Editor license and redistribution of the Products in any form must
+ * include this license and copyright notice.
+ *
+ * THE SPINE RUNTIMES ARE PROVIDED BY ESOTERIC SOFTWARE LLC "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ESOTERIC SOFTWARE LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES,
+ * BUSINESS INTERRUPTION, OR LOSS OF USE, DATA, OR PROFITS) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THE SPINE RUNTIMES, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#pragma once
+
+#include "SpineCommon.h"
+
+#if defined(SPINE_GODOT_EXTENSION) || VERSION_MAJOR > 3
+
+#ifdef SPINE_GODOT_EXTENSION
+#include <godot_cpp/variant/dictionary.hpp>
+#else
+#include "core/variant/dictionary.h"
+#endif
+
+// Steps a number of sprites for a number of frames outside of the scene tree
+// and reports the time spent per stage. Meant to be run headless, `benchmarks/`
+// runs it on a sample skeleton with `SpineBenchmark.new().run_json(path)`, given
+// the path of a SpineSkeletonDataResource.
+class SpineBenchmark : public REFCOUNTED {
+	GDCLASS(SpineBenchmark, REFCOUNTED)
+
+protected:
+	int sprites;
+	int frames;
+	float delta;
+	String animation;
+	String skin;
+
+	static void _bind_methods();
+
+public:
+	SpineBenchmark();
+
+	void set_sprites(int sprites);
+
+	int get_sprites();
+
+	void set_frames(int frames);
+
+	int get_frames();
+
+	void set_delta(float delta);
+
+	float get_delta();
+
+	void set_animation(const String &animation);
+
+	String get_animation();
+
+	void set_skin(const String &skin);
+
+	String get_skin();
+
+	Dictionary run(const String &path);
+
+	String run_json(const String &path);
+};
+
+#endif
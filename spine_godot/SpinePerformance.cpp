@@ -0,0 +1,142 @@
+/******************************************************************************
+ * Spine Runtimes License Agreement
+ * Last updated April 5, 2025. Replaces all prior versions.
+ *
+ * Copyright (c) 2013-2025, Esoteric Software LLC
+ *
+ * Integration of the Spine Runtimes into software or otherwise creating
+ * derivative works of the Spine Runtimes is permitted under the terms and
+ * conditions of Section 2 of the Spine Editor License Agreement:
+ * http://esotericsoftware.com/spine-editor-license
+ *
+ * Otherwise, it is permitted to integrate the Spine Runtimes into software
+ * or otherwise create derivative works of the Spine Runtimes (collectively,
+ * "Products"), provided that each user of the Products must obtain their own
+ * Spine Editor license and redistribution of the Products in any form must
+ * include this license and copyright notice.
+ *
+ * THE SPINE RUNTIMES ARE PROVIDED BY ESOTERIC SOFTWARE LLC "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ESOTERIC SOFTWARE LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES,
+ * BUSINESS INTERRUPTION, OR LOSS OF USE, DATA, OR PROFITS) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THE SPINE RUNTIMES, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#include "SpinePerformance.h"
+
+#ifdef SPINE_GODOT_EXTENSION
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/performance.hpp>
+#include <godot_cpp/classes/time.hpp>
+#include <godot_cpp/variant/callable_method_pointer.hpp>
+#else
+#include "core/os/os.h"
+#if VERSION_MAJOR > 3
+#include "core/config/engine.h"
+#include "core/object/callable_method_pointer.h"
+#include "main/performance.h"
+#else
+#include "core/engine.h"
+#endif
+#endif
+
+SpinePerformance::FrameCounter SpinePerformance::counters[SpinePerformance::COUNTER_MAX];
+std::atomic<int> SpinePerformance::sprites{0};
+bool SpinePerformance::monitors_registered = false;
+
+uint64_t SpinePerformance::current_frame() {
+	return Engine::get_singleton()->get_process_frames();
+}
+
+uint64_t SpinePerformance::get_ticks_usec() {
+#ifdef SPINE_GODOT_EXTENSION
+	return Time::get_singleton()->get_ticks_usec();
+#else
+	return OS::get_singleton()->get_ticks_usec();
+#endif
+}
+
+void SpinePerformance::add(Counter counter, int64_t value) {
+	FrameCounter &c = counters[counter];
+	uint64_t now = current_frame();
+	uint64_t frame = c.frame.load();
+	// First add of a new frame moves the running value to the finished frame.
+	if (frame != now && c.frame.compare_exchange_strong(frame, now)) {
+		c.last_value.store(c.value.exchange(0));
+		c.last_frame.store(frame);
+	}
+	c.value += value;
+}
+
+int64_t SpinePerformance::get(Counter counter) {
+	FrameCounter &c = counters[counter];
+	uint64_t now = current_frame();
+	uint64_t frame = c.frame.load();
+	if (frame + 1 == now) return c.value.load();
+	if (frame == now && c.last_frame.load() + 1 == now) return c.last_value.load();
+	return 0;
+}
+
+Variant SpinePerformance::_get_counter(int counter) {
+	return get((Counter) counter);
+}
+
+Variant SpinePerformance::_get_time(int counter) {
+	return get((Counter) counter) / 1000.0;
+}
+
+Variant SpinePerformance::_get_sprites() {
+	return sprites.load();
+}
+
+void SpinePerformance::sprite_entered() {
+	sprites++;
+	register_monitors();
+}
+
+void SpinePerformance::sprite_exited() {
+	sprites--;
+}
+
+void SpinePerformance::register_monitors() {
+#if defined(SPINE_GODOT_EXTENSION) || VERSION_MAJOR > 3
+	// Performance does not exist yet while modules initialize, so monitors are
+	// registered with the first sprite entering the tree.
+	if (monitors_registered || !Performance::get_singleton()) return;
+	monitors_registered = true;
+	Performance *performance = Performance::get_singleton();
+	struct Monitor {
+		const char *name;
+		Counter counter;
+		bool time;
+	};
+	static const Monitor monitors[] = {
+			{"Spine/Triangles", TRIANGLES, false},
+			{"Spine/Vertices", VERTICES, false},
+			{"Spine/Mesh Uploads", MESH_UPLOADS, false},
+			{"Spine/Bytes Uploaded", BYTES_UPLOADED, false},
+			{"Spine/Skeleton Update (ms)", SKELETON_UPDATE_USEC, true},
+			{"Spine/Mesh Build (ms)", MESH_BUILD_USEC, true},
+	};
+	for (const Monitor &monitor : monitors) {
+		Callable callable = monitor.time ? callable_mp_static(&SpinePerformance::_get_time) : callable_mp_static(&SpinePerformance::_get_counter);
+#ifdef SPINE_GODOT_EXTENSION
+		Array args;
+#else
+		Vector<Variant> args;
+#endif
+		args.push_back((int) monitor.counter);
+		performance->add_custom_monitor(monitor.name, callable, args);
+	}
+#ifdef SPINE_GODOT_EXTENSION
+	performance->add_custom_monitor("Spine/Active Sprites", callable_mp_static(&SpinePerformance::_get_sprites), Array());
+#else
+	performance->add_custom_monitor("Spine/Active Sprites", callable_mp_static(&SpinePerformance::_get_sprites), Vector<Variant>());
+#endif
+#endif
+}
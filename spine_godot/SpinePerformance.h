@@ -0,0 +1,75 @@
+/******************************************************************************
+ * Spine Runtimes License Agreement
+ * Last updated April 5, 2025. Replaces all prior versions.
+ *
+ * Copyright (c) 2013-2025, Esoteric Software LLC
+ *
+ * Integration of the Spine Runtimes into software or otherwise creating
+ * derivative works of the Spine Runtimes is permitted under the terms and
+ * conditions of Section 2 of the Spine Editor License Agreement:
+ * http://esotericsoftware.com/spine-editor-license
+ *
+ * Otherwise, it is permitted to integrate the Spine Runtimes into software
+ * or otherwise create derivative works of the Spine Runtimes (collectively,
+ * "Products"), provided that each user of the Products must obtain their own
+ * Spine Editor license and redistribution of the Products in any form must
+ * include this license and copyright notice.
+ *
+ * THE SPINE RUNTIMES ARE PROVIDED BY ESOTERIC SOFTWARE LLC "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ESOTERIC SOFTWARE LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES,
+ * BUSINESS INTERRUPTION, OR LOSS OF USE, DATA, OR PROFITS) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THE SPINE RUNTIMES, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#pragma once
+
+#include "SpineCommon.h"
+#include <atomic>
+#include <cstdint>
+
+// Counters behind the "Spine/..." custom monitors of the Performance singleton,
+// aggregated over all sprites. Values are added during a process frame and
+// reported for the last finished one.
+class SpinePerformance {
+public:
+	enum Counter {
+		TRIANGLES,
+		VERTICES,
+		MESH_UPLOADS,
+		BYTES_UPLOADED,
+		SKELETON_UPDATE_USEC,
+		MESH_BUILD_USEC,
+		COUNTER_MAX
+	};
+
+private:
+	struct FrameCounter {
+		std::atomic<uint64_t> frame{0};
+		std::atomic<int64_t> value{0};
+		std::atomic<int64_t> last_value{0};
+		std::atomic<uint64_t> last_frame{0};
+	};
+
+	static FrameCounter counters[COUNTER_MAX];
+	static std::atomic<int> sprites;
+	static bool monitors_registered;
+
+	static uint64_t current_frame();
+	static Variant _get_counter(int counter);
+	static Variant _get_time(int counter);
+	static Variant _get_sprites();
+
+public:
+	static void add(Counter counter, int64_t value);
+	static int64_t get(Counter counter);
+	static uint64_t get_ticks_usec();
+	static void sprite_entered();
+	static void sprite_exited();
+	static void register_monitors();
+};
@@ -29,6 +29,7 @@
 
 #include "SpineSkeletonDataResource.h"
 #include "SpineCommon.h"
+#include "SpinePerformance.h"
 
 #ifdef SPINE_GODOT_EXTENSION
 #include <godot_cpp/classes/encoded_object_as_id.hpp>
@@ -260,6 +261,66 @@ SpineSkeletonDataResource::~SpineSkeletonDataResource() {
 	delete animation_state_data;
 }
 
+#ifdef SPINE_GPU_SKINNING
+void SpineSkeletonDataResource::clear_skinning_data() {
+	// The attachments are owned by the skeleton data, the texture is reused.
+	MutexLock lock(skinning_mutex);
+	skinning_offsets.clear();
+	skinning_vertices = 0;
+	skinning_data_changed = false;
+}
+
+int SpineSkeletonDataResource::get_skinning_offset(spine::MeshAttachment *mesh) {
+	MutexLock lock(skinning_mutex);
+	int *cached = skinning_offsets.getptr(mesh);
+	if (cached) return *cached;
+
+	int offset = skinning_vertices;
+	skinning_vertices += (int) mesh->getWorldVerticesLength() / 2;
+	// Grow by whole rows, doubling, so the texture is recreated rarely.
+	int rows = (skinning_vertices * 4 + SKINNING_TEXTURE_WIDTH - 1) / SKINNING_TEXTURE_WIDTH;
+	int row_size = SKINNING_TEXTURE_WIDTH * 4 * sizeof(float);
+	if (rows * row_size > skinning_data.size()) skinning_data.resize(next_power_of_2(rows) * row_size);
+
+	spine::Vector<size_t> &bones = mesh->getBones();
+	spine::Vector<float> &vertices = mesh->getVertices();
+	float *texels = (float *) skinning_data.ptrw();
+	// Unused influences keep a zero weight.
+	for (size_t v = 0, b = 0, texel = offset * 4; v < bones.size(); texel += 4) {
+		int num_influences = (int) bones[v++];
+		memset(texels + texel * 4, 0, 4 * 4 * sizeof(float));
+		for (int k = 0; k < num_influences; k++, v++, b += 3) {
+			float *influence = texels + (texel + k) * 4;
+			influence[0] = (float) bones[v];
+			influence[1] = vertices[b + 2];
+			influence[2] = vertices[b];
+			influence[3] = vertices[b + 1];
+		}
+	}
+	skinning_offsets.insert(mesh, offset);
+	skinning_data_changed = true;
+	return offset;
+}
+
+Ref<ImageTexture> SpineSkeletonDataResource::get_skinning_texture() {
+	MutexLock lock(skinning_mutex);
+	if (skinning_data_changed) {
+		int height = skinning_data.size() / (SKINNING_TEXTURE_WIDTH * 4 * sizeof(float));
+		Ref<Image> image = Image::create_from_data(SKINNING_TEXTURE_WIDTH, height, false, Image::FORMAT_RGBAF, skinning_data);
+		if (skinning_texture.is_null()) {
+			skinning_texture = ImageTexture::create_from_image(image);
+		} else if (skinning_texture->get_height() == height) {
+			skinning_texture->update(image);
+		} else {
+			skinning_texture->set_image(image);
+		}
+		SpinePerformance::add(SpinePerformance::BYTES_UPLOADED, skinning_data.size());
+		skinning_data_changed = false;
+	}
+	return skinning_texture;
+}
+#endif
+
 #ifdef TOOLS_ENABLED
 #if VERSION_MAJOR > 3
 void SpineSkeletonDataResource::_on_resources_reimported(const PackedStringArray &resources) {
@@ -305,6 +366,9 @@ void SpineSkeletonDataResource::update_skeleton_data() {
 		delete animation_state_data;
 		animation_state_data = nullptr;
 	}
+#ifdef SPINE_GPU_SKINNING
+	clear_skinning_data();
+#endif
 
 	emit_signal(SNAME("_internal_spine_objects_invalidated"));
 
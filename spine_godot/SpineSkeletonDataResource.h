@@ -40,6 +40,17 @@
 #include "SpineSlotData.h"
 #include "SpineTransformConstraintData.h"
 
+// Weighted meshes can be skinned by a canvas_item shader, see SpineSprite::gpu_skinning.
+#if !defined(SPINE_GODOT_EXTENSION) && VERSION_MAJOR > 3
+#define SPINE_GPU_SKINNING
+#include "core/os/mutex.h"
+#include "core/templates/hash_map.h"
+#include "scene/resources/image_texture.h"
+
+// Row width of the skinning data textures, must match texel() in the skinning shader.
+#define SKINNING_TEXTURE_WIDTH 1024
+#endif
+
 class SpineAnimationMix : public Resource {
 	GDCLASS(SpineAnimationMix, Resource)
 
@@ -81,6 +92,19 @@ private:
 	spine::SkeletonData *skeleton_data;
 	spine::AnimationStateData *animation_state_data;
 
+#ifdef SPINE_GPU_SKINNING
+	// Influences of the GPU skinned meshes, 4 texels per vertex, shared by all
+	// sprites using this skeleton data. Filled as attachments are first skinned.
+	Mutex skinning_mutex;
+	HashMap<spine::MeshAttachment *, int> skinning_offsets;
+	Vector<uint8_t> skinning_data;
+	int skinning_vertices = 0;
+	bool skinning_data_changed = false;
+	Ref<ImageTexture> skinning_texture;
+
+	void clear_skinning_data();
+#endif
+
 	void update_skeleton_data();
 
 #ifdef SPINE_GODOT_EXTENSION
@@ -110,6 +134,15 @@ public:
 		return animation_state_data;
 	}
 
+#ifdef SPINE_GPU_SKINNING
+	// Returns the index of the first vertex of the mesh in the skinning texture,
+	// safe to call from the threaded sprite updates.
+	int get_skinning_offset(spine::MeshAttachment *mesh);
+
+	// Uploads pending influences, main thread only. The texture keeps its RID when it grows.
+	Ref<ImageTexture> get_skinning_texture();
+#endif
+
 #ifdef SPINE_GODOT_EXTENSION
 	void get_animation_names(PackedStringArray &animation_names) const;
 
@@ -33,6 +33,8 @@
 #include "SpineSkeleton.h"
 #include "SpineRendererObject.h"
 #include "SpineSlotNode.h"
+#include "SpinePerformance.h"
+#include "SpineSpriteServer.h"
 
 #ifdef SPINE_GODOT_EXTENSION
 #include <godot_cpp/core/memory.hpp>
@@ -101,6 +103,9 @@ public:
 #else
 	Vector<Vector2> scratch_points;
 #endif
+#ifdef SPINE_GPU_SKINNING
+	Ref<Shader> skinning_shaders[4] = {};
+#endif
 
 	SpineSpriteStatics() : sprite_count(0) {
 		quad_indices.setSize(6, 0);
@@ -129,6 +134,42 @@ public:
 		default_materials[spine::BlendMode_Screen] = material_screen;
 	}
 
+#ifdef SPINE_GPU_SKINNING
+	Ref<Shader> get_skinning_shader(spine::BlendMode blend_mode) {
+		if (skinning_shaders[blend_mode].is_valid()) return skinning_shaders[blend_mode];
+		static const char *render_modes[4] = {"blend_mix", "blend_add", "blend_mul", "blend_sub"};
+		String code = String("shader_type canvas_item;\nrender_mode ") + render_modes[blend_mode] + ";\n" + R"(
+uniform sampler2D skin_data : filter_nearest;
+uniform sampler2D bone_data : filter_nearest;
+
+ivec2 texel(int index) {
+	return ivec2(index % 1024, index / 1024);
+}
+
+void vertex() {
+	// Up to 4 influences per vertex, each (bone, weight, x, y) in bone space.
+	// Bones are stored as (a, b, c, d) and (world x, world y).
+	// VERTEX.x is the index of the vertex in skin_data.
+	int vertex = int(VERTEX.x + 0.5);
+	vec2 position = vec2(0.0);
+	for (int i = 0; i < 4; i++) {
+		vec4 influence = texelFetch(skin_data, texel(vertex * 4 + i), 0);
+		int bone = int(influence.x + 0.5);
+		vec4 abcd = texelFetch(bone_data, texel(bone * 2), 0);
+		vec2 world = texelFetch(bone_data, texel(bone * 2 + 1), 0).xy;
+		position += (vec2(influence.z * abcd.x + influence.w * abcd.y, influence.z * abcd.z + influence.w * abcd.w) + world) * influence.y;
+	}
+	VERTEX = position;
+}
+)";
+		Ref<Shader> shader;
+		shader.instantiate();
+		shader->set_code(code);
+		skinning_shaders[blend_mode] = shader;
+		return shader;
+	}
+#endif
+
 	static SpineSpriteStatics &instance() {
 		if (!_instance) {
 			_instance = new SpineSpriteStatics();
@@ -227,6 +268,9 @@ void SpineMesh2D::update_mesh(const PackedVector2Array &vertices,
 							  const PackedColorArray &colors,
 							  const PackedInt32Array &indices,
 							  SpineRendererObject *renderer_object) {
+	SpinePerformance::add(SpinePerformance::TRIANGLES, indices.size() / 3);
+	SpinePerformance::add(SpinePerformance::VERTICES, vertices.size());
+	SpinePerformance::add(SpinePerformance::MESH_UPLOADS, 1);
 	if (!mesh.is_valid() || mesh_vertices.size() != num_vertices || mesh_indices.size() != num_indices || indices_changed) {
 		if (mesh.is_valid()) {
 			RS::get_singleton()->free_rid(mesh);
@@ -251,14 +295,9 @@ void SpineMesh2D::update_mesh(const PackedVector2Array &vertices,
 		num_vertices = mesh_vertices.size();
 		num_indices = mesh_indices.size();
 		indices_changed = false;
+		SpinePerformance::add(SpinePerformance::BYTES_UPLOADED, vertex_buffer.size() + attribute_buffer.size() + num_indices * sizeof(int32_t));
 	} else {
 		AABB aabb_new;
-		uint8_t color[4] = {
-				uint8_t(CLAMP(mesh_colors[0].r * 255.0, 0.0, 255.0)),
-				uint8_t(CLAMP(mesh_colors[0].g * 255.0, 0.0, 255.0)),
-				uint8_t(CLAMP(mesh_colors[0].b * 255.0, 0.0, 255.0)),
-				uint8_t(CLAMP(mesh_colors[0].a * 255.0, 0.0, 255.0))};
-
 		uint8_t *vertex_write_buffer = vertex_buffer.ptrw();
 		uint8_t *attribute_write_buffer = attribute_buffer.ptrw();
 		for (int i = 0; i < mesh_vertices.size(); i++) {
@@ -270,6 +309,12 @@ void SpineMesh2D::update_mesh(const PackedVector2Array &vertices,
 				aabb_new.expand_to(Vector3(vertex.x, vertex.y, 0));
 			}
 
+			const Color &vertex_color = mesh_colors[i];
+			uint8_t color[4] = {
+					uint8_t(CLAMP(vertex_color.r * 255.0, 0.0, 255.0)),
+					uint8_t(CLAMP(vertex_color.g * 255.0, 0.0, 255.0)),
+					uint8_t(CLAMP(vertex_color.b * 255.0, 0.0, 255.0)),
+					uint8_t(CLAMP(vertex_color.a * 255.0, 0.0, 255.0))};
 			float uv[2] = {(float) mesh_uvs[i].x, (float) mesh_uvs[i].y};
 			memcpy(&vertex_write_buffer[i * vertex_stride + surface_offsets[RS::ARRAY_VERTEX]], &vertex, sizeof(float) * 2);
 			memcpy(&attribute_write_buffer[i * attribute_stride + surface_offsets[RS::ARRAY_COLOR]], color, 4);
@@ -278,6 +323,7 @@ void SpineMesh2D::update_mesh(const PackedVector2Array &vertices,
 		RS::get_singleton()->mesh_surface_update_vertex_region(mesh, 0, 0, vertex_buffer);
 		RS::get_singleton()->mesh_surface_update_attribute_region(mesh, 0, 0, attribute_buffer);
 		RS::get_singleton()->mesh_set_custom_aabb(mesh, aabb_new);
+		SpinePerformance::add(SpinePerformance::BYTES_UPLOADED, vertex_buffer.size() + attribute_buffer.size());
 	}
 
 	RenderingServer::get_singleton()->canvas_item_add_mesh(this->get_canvas_item(), mesh, Transform2D(), Color(1, 1, 1, 1), mesh_renderer_object->canvas_texture->get_rid());
@@ -288,6 +334,17 @@ void SpineMesh2D::update_mesh(const Vector<Point2> &mesh_vertices,
 							  const Vector<Color> &mesh_colors,
 							  const Vector<int> &mesh_indices,
 							  SpineRendererObject *mesh_renderer_object) {
+	SpinePerformance::add(SpinePerformance::TRIANGLES, mesh_indices.size() / 3);
+	SpinePerformance::add(SpinePerformance::VERTICES, mesh_vertices.size());
+#ifdef SPINE_GPU_SKINNING
+	if (skinned && mesh.is_valid() && mesh_vertices.size() == num_vertices && mesh_indices.size() == num_indices && !indices_changed) {
+		// The shader positions the vertices, only the bounds and the tint change.
+		RS::get_singleton()->mesh_set_custom_aabb(mesh, skinned_aabb);
+		RS::get_singleton()->canvas_item_add_mesh(this->get_canvas_item(), mesh, Transform2D(), skinned_modulate, mesh_renderer_object->canvas_texture->get_rid());
+		return;
+	}
+#endif
+	SpinePerformance::add(SpinePerformance::MESH_UPLOADS, 1);
 #if VERSION_MAJOR > 3
 	if (!mesh.is_valid() || mesh_vertices.size() != num_vertices || mesh_indices.size() != num_indices || indices_changed) {
 		if (mesh.is_valid()) {
@@ -318,15 +375,14 @@ void SpineMesh2D::update_mesh(const Vector<Point2> &mesh_vertices,
 		vertex_buffer = surface.vertex_data;
 		attribute_buffer = surface.attribute_data;
 		indices_changed = false;
+		SpinePerformance::add(SpinePerformance::BYTES_UPLOADED, surface.vertex_data.size() + surface.attribute_data.size() + surface.index_data.size());
+#ifdef SPINE_GPU_SKINNING
+		if (skinned) RS::get_singleton()->mesh_set_custom_aabb(mesh, skinned_aabb);
+#endif
 	} else {
 		AABB aabb_new;
 		uint8_t *vertex_write_buffer = vertex_buffer.ptrw();
 		uint8_t *attribute_write_buffer = attribute_buffer.ptrw();
-		uint8_t color[4] = {
-				uint8_t(CLAMP(mesh_colors[0].r * 255.0, 0.0, 255.0)),
-				uint8_t(CLAMP(mesh_colors[0].g * 255.0, 0.0, 255.0)),
-				uint8_t(CLAMP(mesh_colors[0].b * 255.0, 0.0, 255.0)),
-				uint8_t(CLAMP(mesh_colors[0].a * 255.0, 0.0, 255.0))};
 
 		for (int i = 0; i < mesh_vertices.size(); i++) {
 			Vector2 vertex(mesh_vertices[i]);
@@ -337,6 +393,12 @@ void SpineMesh2D::update_mesh(const Vector<Point2> &mesh_vertices,
 				aabb_new.expand_to(Vector3(vertex.x, vertex.y, 0));
 			}
 
+			const Color &vertex_color = mesh_colors[i];
+			uint8_t color[4] = {
+					uint8_t(CLAMP(vertex_color.r * 255.0, 0.0, 255.0)),
+					uint8_t(CLAMP(vertex_color.g * 255.0, 0.0, 255.0)),
+					uint8_t(CLAMP(vertex_color.b * 255.0, 0.0, 255.0)),
+					uint8_t(CLAMP(vertex_color.a * 255.0, 0.0, 255.0))};
 			float uv[2] = {(float) mesh_uvs[i].x, (float) mesh_uvs[i].y};
 			memcpy(&vertex_write_buffer[i * vertex_stride + surface_offsets[RS::ARRAY_VERTEX]], &vertex, sizeof(float) * 2);
 			memcpy(&attribute_write_buffer[i * attribute_stride + surface_offsets[RS::ARRAY_COLOR]], color, 4);
@@ -345,9 +407,15 @@ void SpineMesh2D::update_mesh(const Vector<Point2> &mesh_vertices,
 		RS::get_singleton()->mesh_surface_update_vertex_region(mesh, 0, 0, vertex_buffer);
 		RS::get_singleton()->mesh_surface_update_attribute_region(mesh, 0, 0, attribute_buffer);
 		RS::get_singleton()->mesh_set_custom_aabb(mesh, aabb_new);
+		SpinePerformance::add(SpinePerformance::BYTES_UPLOADED, vertex_buffer.size() + attribute_buffer.size());
 	}
 
-	RenderingServer::get_singleton()->canvas_item_add_mesh(this->get_canvas_item(), mesh, Transform2D(), Color(1, 1, 1, 1), mesh_renderer_object->canvas_texture->get_rid());
+#ifdef SPINE_GPU_SKINNING
+	Color modulate = skinned ? skinned_modulate : Color(1, 1, 1, 1);
+#else
+	Color modulate(1, 1, 1, 1);
+#endif
+	RenderingServer::get_singleton()->canvas_item_add_mesh(this->get_canvas_item(), mesh, Transform2D(), modulate, mesh_renderer_object->canvas_texture->get_rid());
 #else
 	if (!mesh.is_valid() || mesh_vertices.size() != num_vertices || mesh_indices.size() != num_indices || indices_changed) {
 		if (mesh.is_valid()) {
@@ -374,12 +442,6 @@ void SpineMesh2D::update_mesh(const Vector<Point2> &mesh_vertices,
 		AABB aabb_new;
 		PoolVector<uint8_t>::Write write_buffer = mesh_buffer.write();
 
-		uint8_t color[4] = {
-				uint8_t(CLAMP(mesh_colors[0].r * 255.0, 0.0, 255.0)),
-				uint8_t(CLAMP(mesh_colors[0].g * 255.0, 0.0, 255.0)),
-				uint8_t(CLAMP(mesh_colors[0].b * 255.0, 0.0, 255.0)),
-				uint8_t(CLAMP(mesh_colors[0].a * 255.0, 0.0, 255.0))};
-
 		for (int i = 0; i < mesh_vertices.size(); i++) {
 			Vector2 vertex(mesh_vertices[i]);
 			if (i == 0) {
@@ -389,6 +451,12 @@ void SpineMesh2D::update_mesh(const Vector<Point2> &mesh_vertices,
 				aabb_new.expand_to(Vector3(vertex.x, vertex.y, 0));
 			}
 
+			const Color &vertex_color = mesh_colors[i];
+			uint8_t color[4] = {
+					uint8_t(CLAMP(vertex_color.r * 255.0, 0.0, 255.0)),
+					uint8_t(CLAMP(vertex_color.g * 255.0, 0.0, 255.0)),
+					uint8_t(CLAMP(vertex_color.b * 255.0, 0.0, 255.0)),
+					uint8_t(CLAMP(vertex_color.a * 255.0, 0.0, 255.0))};
 			float uv[2] = {(float) mesh_uvs[i].x, (float) mesh_uvs[i].y};
 			memcpy(&write_buffer[i * mesh_stride[VS::ARRAY_VERTEX] + mesh_surface_offsets[VS::ARRAY_VERTEX]], &vertex, sizeof(float) * 2);
 			memcpy(&write_buffer[i * mesh_stride[VS::ARRAY_TEX_UV] + mesh_surface_offsets[VS::ARRAY_TEX_UV]], uv, 8);
@@ -440,6 +508,24 @@ void SpineSprite::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_time_scale"), &SpineSprite::get_time_scale);
 	ClassDB::bind_method(D_METHOD("set_time_scale", "v"), &SpineSprite::set_time_scale);
 
+	ClassDB::bind_method(D_METHOD("set_lod_enabled", "v"), &SpineSprite::set_lod_enabled);
+	ClassDB::bind_method(D_METHOD("is_lod_enabled"), &SpineSprite::is_lod_enabled);
+	ClassDB::bind_method(D_METHOD("set_lod_update_interval", "v"), &SpineSprite::set_lod_update_interval);
+	ClassDB::bind_method(D_METHOD("get_lod_update_interval"), &SpineSprite::get_lod_update_interval);
+	ClassDB::bind_method(D_METHOD("set_lod_max_fps", "v"), &SpineSprite::set_lod_max_fps);
+	ClassDB::bind_method(D_METHOD("get_lod_max_fps"), &SpineSprite::get_lod_max_fps);
+	ClassDB::bind_method(D_METHOD("set_lod_screen_size", "v"), &SpineSprite::set_lod_screen_size);
+	ClassDB::bind_method(D_METHOD("get_lod_screen_size"), &SpineSprite::get_lod_screen_size);
+
+	ClassDB::bind_method(D_METHOD("set_batch_slots", "v"), &SpineSprite::set_batch_slots);
+	ClassDB::bind_method(D_METHOD("is_batch_slots"), &SpineSprite::is_batch_slots);
+	ClassDB::bind_method(D_METHOD("set_threaded", "v"), &SpineSprite::set_threaded);
+	ClassDB::bind_method(D_METHOD("is_threaded"), &SpineSprite::is_threaded);
+	ClassDB::bind_method(D_METHOD("set_gpu_skinning", "v"), &SpineSprite::set_gpu_skinning);
+	ClassDB::bind_method(D_METHOD("is_gpu_skinning"), &SpineSprite::is_gpu_skinning);
+	ClassDB::bind_method(D_METHOD("set_batched_pose", "v"), &SpineSprite::set_batched_pose);
+	ClassDB::bind_method(D_METHOD("is_batched_pose"), &SpineSprite::is_batched_pose);
+
 	ClassDB::bind_method(D_METHOD("set_debug_root", "v"), &SpineSprite::set_debug_root);
 	ClassDB::bind_method(D_METHOD("get_debug_root"), &SpineSprite::get_debug_root);
 	ClassDB::bind_method(D_METHOD("set_debug_root_color", "v"), &SpineSprite::set_debug_root_color);
@@ -488,6 +574,15 @@ void SpineSprite::_bind_methods() {
 
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "skeleton_data_res", PropertyHint::PROPERTY_HINT_RESOURCE_TYPE, "SpineSkeletonDataResource"), "set_skeleton_data_res", "get_skeleton_data_res");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "update_mode", PROPERTY_HINT_ENUM, "Process,Physics,Manual"), "set_update_mode", "get_update_mode");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "batch_slots"), "set_batch_slots", "is_batch_slots");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "threaded"), "set_threaded", "is_threaded");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "gpu_skinning"), "set_gpu_skinning", "is_gpu_skinning");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "batched_pose"), "set_batched_pose", "is_batched_pose");
+	ADD_GROUP("LOD", "lod_");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "lod_enabled"), "set_lod_enabled", "is_lod_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "lod_update_interval", PROPERTY_HINT_RANGE, "1,16,1"), "set_lod_update_interval", "get_lod_update_interval");
+	ADD_PROPERTY(PropertyInfo(VARIANT_FLOAT, "lod_max_fps", PROPERTY_HINT_RANGE, "0,240,1"), "set_lod_max_fps", "get_lod_max_fps");
+	ADD_PROPERTY(PropertyInfo(VARIANT_FLOAT, "lod_screen_size", PROPERTY_HINT_RANGE, "0,4096,1,suffix:px"), "set_lod_screen_size", "get_lod_screen_size");
 	ADD_GROUP("Materials", "");
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "normal_material", PROPERTY_HINT_RESOURCE_TYPE, "Material"), "set_normal_material", "get_normal_material");
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "additive_material", PROPERTY_HINT_RESOURCE_TYPE, "Material"), "set_additive_material", "get_additive_material");
@@ -515,7 +610,12 @@ void SpineSprite::_bind_methods() {
 	// Filled in in _get_property_list()
 }
 
-SpineSprite::SpineSprite() : update_mode(SpineConstant::UpdateMode_Process), time_scale(1.0), preview_skin("Default"), preview_animation("-- Empty --"), preview_frame(false), preview_time(0), skeleton_clipper(nullptr), modified_bones(false) {
+SpineSprite::SpineSprite() : update_mode(SpineConstant::UpdateMode_Process), time_scale(1.0), lod_enabled(true), lod_update_interval(1), lod_max_fps(0), lod_screen_size(0), lod_skipped_time(0), lod_skipped_frames(0), lod_local_size(0), batch_slots(false), preview_skin("Default"), preview_animation("-- Empty --"), preview_frame(false), preview_time(0), skeleton_clipper(nullptr), modified_bones(false), threaded(false), update_queued(false), queued_delta(0), update_delta(0), update_visible(false), in_threaded_update(false), meshes_incomplete(false), gpu_skinning(false), batched_pose(false)
+#ifdef SPINE_GPU_SKINNING
+		,
+		bone_data_width(0), bone_data_height(0), bone_data_changed(false)
+#endif
+{
 	skeleton_clipper = new spine::SkeletonClipping();
 	auto statics = SpineSpriteStatics::instance();
 
@@ -536,6 +636,9 @@ SpineSprite::SpineSprite() : update_mode(SpineConstant::UpdateMode_Process), tim
 	debug_clipping = false;
 	debug_clipping_color = Color(0.8, 0, 0, 0.8);
 
+	// Spread sprites with the same interval over different ticks.
+	lod_skipped_frames = (int) ((uint64_t) get_instance_id() % 8);
+
 	statics.sprite_count++;
 }
 
@@ -576,6 +679,7 @@ void SpineSprite::on_skeleton_data_changed() {
 	if (skeleton_data_res.is_valid() && skeleton_data_res->is_skeleton_data_loaded()) {
 		skeleton = Ref<SpineSkeleton>(memnew(SpineSkeleton));
 		skeleton->set_spine_sprite(this);
+		skeleton->get_spine_object()->setBatchedPose(batched_pose);
 
 		animation_state = Ref<SpineAnimationState>(memnew(SpineAnimationState));
 		animation_state->set_spine_sprite(this);
@@ -586,10 +690,11 @@ void SpineSprite::on_skeleton_data_changed() {
 		skeleton->update_world_transform();
 		generate_meshes_for_slots(skeleton);
 
+		// Direct update, the first pose must not wait for a LOD step.
 		if (update_mode == SpineConstant::UpdateMode_Process) {
-			_notification(NOTIFICATION_INTERNAL_PROCESS);
+			update_skeleton(get_process_delta_time());
 		} else if (update_mode == SpineConstant::UpdateMode_Physics) {
-			_notification(NOTIFICATION_INTERNAL_PHYSICS_PROCESS);
+			update_skeleton(get_physics_process_delta_time());
 		}
 	}
 
@@ -598,17 +703,28 @@ void SpineSprite::on_skeleton_data_changed() {
 
 void SpineSprite::generate_meshes_for_slots(Ref<SpineSkeleton> skeleton_ref) {
 	auto spine_skeleton = skeleton_ref->get_spine_object();
-	auto statics = SpineSpriteStatics::instance();
-	for (int i = 0, n = (int) spine_skeleton->getSlots().size(); i < n; i++) {
-		auto mesh_instance = memnew(SpineMesh2D);
-		mesh_instance->set_position(Vector2(0, 0));
-		mesh_instance->set_material(statics.default_materials[spine::BlendMode_Normal]);
-		// Needed so that debug drawables are rendered in front of attachments
-		mesh_instance->set_draw_behind_parent(true);
-		add_child(mesh_instance);
-		mesh_instances.push_back(mesh_instance);
+	int num_slots = (int) spine_skeleton->getSlots().size();
+	// Batches are created on demand while building the meshes.
+	int num_instances = batch_slots ? MIN(num_slots, 1) : num_slots;
+	for (int i = 0; i < num_instances; i++) {
+		create_mesh_instance();
+	}
+	for (int i = 0; i < num_slots; i++) {
 		slot_nodes.add(spine::Vector<SpineSlotNode *>());
 	}
+	slot_batches.setSize(num_slots, -1);
+}
+
+SpineMesh2D *SpineSprite::create_mesh_instance() {
+	auto &statics = SpineSpriteStatics::instance();
+	auto mesh_instance = memnew(SpineMesh2D);
+	mesh_instance->set_position(Vector2(0, 0));
+	mesh_instance->set_material(statics.default_materials[spine::BlendMode_Normal]);
+	// Needed so that debug drawables are rendered in front of attachments
+	mesh_instance->set_draw_behind_parent(true);
+	add_child(mesh_instance);
+	mesh_instances.push_back(mesh_instance);
+	return mesh_instance;
 }
 
 void SpineSprite::remove_meshes() {
@@ -618,6 +734,7 @@ void SpineSprite::remove_meshes() {
 	}
 	mesh_instances.clear();
 	slot_nodes.clear();
+	slot_batches.clear();
 }
 
 void SpineSprite::sort_slot_nodes() {
@@ -639,13 +756,28 @@ void SpineSprite::sort_slot_nodes() {
 		slot_nodes[slot_node->get_slot_index()].add(slot_node);
 	}
 
+	// Batches are only known after update_meshes(), which moves the slot nodes itself.
+	if (!batch_slots) move_slot_nodes();
+}
+
+void SpineSprite::move_slot_nodes() {
+	auto &draw_order = skeleton->get_spine_object()->getDrawOrder();
 	for (int i = 0; i < (int) draw_order.size(); i++) {
 		int slot_index = draw_order[i]->getData().getIndex();
-		int mesh_index = mesh_instances[i]->get_index();
 		spine::Vector<SpineSlotNode *> &nodes = slot_nodes[slot_index];
+		if (nodes.size() == 0) continue;
+		int mesh_index;
+		if (!batch_slots) {
+			mesh_index = mesh_instances[i]->get_index() + 1;
+		} else if (slot_batches[i] >= 0) {
+			mesh_index = mesh_instances[slot_batches[i]]->get_index() + 1;
+		} else {
+			// Nothing was drawn before this slot yet.
+			mesh_index = mesh_instances[0]->get_index();
+		}
 		for (int j = 0; j < (int) nodes.size(); j++) {
 			auto node = nodes[j];
-			move_child(node, mesh_index + 1);
+			move_child(node, mesh_index);
 		}
 	}
 }
@@ -660,19 +792,29 @@ Ref<SpineAnimationState> SpineSprite::get_animation_state() {
 
 void SpineSprite::_notification(int what) {
 	switch (what) {
+		case NOTIFICATION_ENTER_TREE: {
+			SpinePerformance::sprite_entered();
+			break;
+		}
+		case NOTIFICATION_EXIT_TREE: {
+			SpinePerformance::sprite_exited();
+			break;
+		}
 		case NOTIFICATION_READY: {
 			set_process_internal(update_mode == SpineConstant::UpdateMode_Process);
 			set_physics_process_internal(update_mode == SpineConstant::UpdateMode_Physics);
 			break;
 		}
 		case NOTIFICATION_INTERNAL_PROCESS: {
-			if (update_mode == SpineConstant::UpdateMode_Process)
-				update_skeleton(get_process_delta_time());
+			float delta = get_process_delta_time();
+			if (update_mode == SpineConstant::UpdateMode_Process && lod_step(delta))
+				queue_update_skeleton(delta);
 			break;
 		}
 		case NOTIFICATION_INTERNAL_PHYSICS_PROCESS: {
-			if (update_mode == SpineConstant::UpdateMode_Physics)
-				update_skeleton(get_physics_process_delta_time());
+			float delta = get_physics_process_delta_time();
+			if (update_mode == SpineConstant::UpdateMode_Physics && lod_step(delta))
+				queue_update_skeleton(delta);
 			break;
 		}
 		case NOTIFICATION_DRAW: {
@@ -813,18 +955,25 @@ bool SpineSprite::_set(const StringName &property, const Variant &value) {
 	return false;
 }
 
+bool SpineSprite::has_spine_objects() {
+	return skeleton_data_res.is_valid() &&
+		   skeleton_data_res->is_skeleton_data_loaded() &&
+		   skeleton.is_valid() &&
+		   skeleton->get_spine_object() &&
+		   animation_state.is_valid() &&
+		   animation_state->get_spine_object();
+}
+
 void SpineSprite::update_skeleton(float delta) {
-	if (!skeleton_data_res.is_valid() ||
-		!skeleton_data_res->is_skeleton_data_loaded() ||
-		!skeleton.is_valid() ||
-		!skeleton->get_spine_object() ||
-		!animation_state.is_valid() ||
-		!animation_state->get_spine_object())
-		return;
+	if (!has_spine_objects()) return;
 
+	uint64_t start = SpinePerformance::get_ticks_usec();
 	emit_signal(SNAME("before_animation_state_update"), this);
 	animation_state->update(delta * time_scale);
-	if (!is_visible_in_tree()) return;
+	if (!is_visible_in_tree()) {
+		SpinePerformance::add(SpinePerformance::SKELETON_UPDATE_USEC, SpinePerformance::get_ticks_usec() - start);
+		return;
+	}
 	emit_signal(SNAME("before_animation_state_apply"), this);
 	animation_state->apply(skeleton);
 	emit_signal(SNAME("before_world_transforms_change"), this);
@@ -833,8 +982,13 @@ void SpineSprite::update_skeleton(float delta) {
 	modified_bones = false;
 	emit_signal(SNAME("world_transforms_changed"), this);
 	if (modified_bones) skeleton->update_world_transform();
+	update_lod_size();
 	sort_slot_nodes();
+	uint64_t meshes_start = SpinePerformance::get_ticks_usec();
+	SpinePerformance::add(SpinePerformance::SKELETON_UPDATE_USEC, meshes_start - start);
 	update_meshes(skeleton);
+	finish_meshes();
+	SpinePerformance::add(SpinePerformance::MESH_BUILD_USEC, SpinePerformance::get_ticks_usec() - meshes_start);
 #if VERSION_MAJOR > 3
 	queue_redraw();
 #else
@@ -842,14 +996,129 @@ void SpineSprite::update_skeleton(float delta) {
 #endif
 }
 
+void SpineSprite::update_lod_size() {
+	if (!lod_enabled || lod_screen_size <= 0) return;
+	// Bone extents are a cheap stand-in for the attachment bounds.
+	auto &bones = skeleton->get_spine_object()->getBones();
+	float min_x = 0, min_y = 0, max_x = 0, max_y = 0;
+	for (int i = 0; i < (int) bones.size(); i++) {
+		float x = bones[i]->getWorldX(), y = bones[i]->getWorldY();
+		if (i == 0 || x < min_x) min_x = x;
+		if (i == 0 || y < min_y) min_y = y;
+		if (i == 0 || x > max_x) max_x = x;
+		if (i == 0 || y > max_y) max_y = y;
+	}
+	lod_local_size = MAX(max_x - min_x, max_y - min_y);
+}
+
+void SpineSprite::queue_update_skeleton(float delta) {
+#if defined(SPINE_GODOT_EXTENSION) || VERSION_MAJOR > 3
+	if (threaded && SpineSpriteServer::get_singleton()) {
+		queued_delta += delta;
+		if (!update_queued) {
+			update_queued = true;
+			SpineSpriteServer::get_singleton()->queue_sprite(this);
+		}
+		return;
+	}
+#endif
+	update_skeleton(delta);
+}
+
+#if defined(SPINE_GODOT_EXTENSION) || VERSION_MAJOR > 3
+bool SpineSprite::threaded_update_begin() {
+	float delta = queued_delta;
+	update_queued = false;
+	queued_delta = 0;
+	if (!has_spine_objects()) return false;
+
+	// Handlers of these signals expect to run in between the update steps.
+	if (has_connections(SNAME("before_animation_state_apply")) || has_connections(SNAME("before_world_transforms_change"))) {
+		update_skeleton(delta);
+		return false;
+	}
+	// Listener events are queued until the threaded update ends, a handler that changes the
+	// animation state would only take effect on the next frame.
+	if (has_connections(SNAME("animation_started")) || has_connections(SNAME("animation_interrupted")) ||
+		has_connections(SNAME("animation_ended")) || has_connections(SNAME("animation_completed")) ||
+		has_connections(SNAME("animation_disposed")) || has_connections(SNAME("animation_event"))) {
+		update_skeleton(delta);
+		return false;
+	}
+
+	emit_signal(SNAME("before_animation_state_update"), this);
+	update_delta = delta;
+	update_visible = is_visible_in_tree();
+	if (update_visible) sort_slot_nodes();
+	// Listener events are kept in the queue until threaded_update_end().
+	animation_state->get_spine_object()->disableQueue();
+	in_threaded_update = true;
+	return true;
+}
+
+void SpineSprite::threaded_update_evaluate() {
+	// Runs on a worker, must not touch the scene tree or emit signals.
+	uint64_t start = SpinePerformance::get_ticks_usec();
+	animation_state->update(update_delta * time_scale);
+	if (!update_visible) {
+		SpinePerformance::add(SpinePerformance::SKELETON_UPDATE_USEC, SpinePerformance::get_ticks_usec() - start);
+		return;
+	}
+	animation_state->apply(skeleton);
+	skeleton->update(update_delta * time_scale);
+	skeleton->update_world_transform();
+	update_lod_size();
+	uint64_t meshes_start = SpinePerformance::get_ticks_usec();
+	SpinePerformance::add(SpinePerformance::SKELETON_UPDATE_USEC, meshes_start - start);
+	update_meshes(skeleton);
+	SpinePerformance::add(SpinePerformance::MESH_BUILD_USEC, SpinePerformance::get_ticks_usec() - meshes_start);
+}
+
+void SpineSprite::threaded_update_end() {
+	in_threaded_update = false;
+	spine::AnimationState *state = animation_state->get_spine_object();
+	state->enableQueue();
+	state->drainQueue();
+	// Listener handlers may have replaced the skeleton data.
+	if (!update_visible || !has_spine_objects()) return;
+
+	modified_bones = false;
+	emit_signal(SNAME("world_transforms_changed"), this);
+	if (modified_bones) {
+		skeleton->update_world_transform();
+		meshes_incomplete = true;
+	}
+	if (meshes_incomplete) update_meshes(skeleton);
+	finish_meshes();
+	queue_redraw();
+}
+#endif
+
 void SpineSprite::update_meshes(Ref<SpineSkeleton> skeleton_ref) {
-	auto statics = SpineSpriteStatics::instance();
+	auto &statics = SpineSpriteStatics::instance();
 	spine::Skeleton *spine_skeleton = skeleton_ref->get_spine_object();
+	spine::Vector<spine::Slot *> &draw_order = spine_skeleton->getDrawOrder();
+	SpineMesh2D *batch = nullptr;
+	int num_batches = 0;
+	bool batch_break = true;
+	spine::BlendMode batch_blend_mode = spine::BlendMode_Normal;
+	Ref<Material> batch_material;
+	meshes_incomplete = false;
+#ifdef SPINE_GPU_SKINNING
+	bone_data_changed = false;
+#endif
 	for (int i = 0, n = (int) spine_skeleton->getSlots().size(); i < n; ++i) {
-		spine::Slot *slot = spine_skeleton->getDrawOrder()[i];
+		spine::Slot *slot = draw_order[i];
 		spine::Attachment *attachment = slot->getAttachment();
-		SpineMesh2D *mesh_instance = mesh_instances[i];
-		mesh_instance->renderer_object = nullptr;
+		SpineMesh2D *mesh_instance = nullptr;
+		if (batch_slots) {
+			// Slot nodes are drawn right after their slot, so the next slot starts a new batch.
+			if (i > 0 && slot_nodes[draw_order[i - 1]->getData().getIndex()].size() > 0) batch_break = true;
+			slot_batches[i] = num_batches - 1;
+		} else {
+			mesh_instance = mesh_instances[i];
+			mesh_instance->renderer_object = nullptr;
+		}
 
 		if (!attachment) {
 			skeleton_clipper->clipEnd(*slot);
@@ -864,7 +1133,7 @@ void SpineSprite::update_meshes(Ref<SpineSkeleton> skeleton_ref) {
 		spine::Color slot_color = slot->getColor();
 		spine::Color tint(skeleton_color.r * slot_color.r, skeleton_color.g * slot_color.g, skeleton_color.b * slot_color.b, skeleton_color.a * slot_color.a);
 		SpineRendererObject *renderer_object;
-		spine::Vector<float> *vertices = &statics.scratch_vertices;
+		spine::Vector<float> *vertices = &scratch_vertices;
 		spine::Vector<float> *uvs;
 		spine::Vector<unsigned short> *indices;
 
@@ -884,18 +1153,25 @@ void SpineSprite::update_meshes(Ref<SpineSkeleton> skeleton_ref) {
 			tint.a *= attachment_color.a;
 		} else if (attachment->getRTTI().isExactly(spine::MeshAttachment::rtti)) {
 			auto *mesh = (spine::MeshAttachment *) attachment;
-
-			vertices->setSize(mesh->getWorldVerticesLength(), 0);
-			mesh->computeWorldVertices(*slot, *vertices);
 			renderer_object = (SpineRendererObject *) ((spine::AtlasRegion *) mesh->getRendererObject())->page->getRendererObject();
-			uvs = &mesh->getUVs();
-			indices = &mesh->getTriangles();
 
 			auto attachment_color = mesh->getColor();
 			tint.r *= attachment_color.r;
 			tint.g *= attachment_color.g;
 			tint.b *= attachment_color.b;
 			tint.a *= attachment_color.a;
+
+#ifdef SPINE_GPU_SKINNING
+			if (mesh_instance && gpu_skinning && update_skinned_mesh(mesh_instance, slot, mesh, tint, renderer_object)) {
+				skeleton_clipper->clipEnd(*slot);
+				continue;
+			}
+#endif
+
+			vertices->setSize(mesh->getWorldVerticesLength(), 0);
+			mesh->computeWorldVertices(*slot, *vertices);
+			uvs = &mesh->getUVs();
+			indices = &mesh->getTriangles();
 		} else if (attachment->getRTTI().isExactly(spine::ClippingAttachment::rtti)) {
 			auto clip = (spine::ClippingAttachment *) attachment;
 			skeleton_clipper->clipStart(*slot, clip);
@@ -918,8 +1194,56 @@ void SpineSprite::update_meshes(Ref<SpineSkeleton> skeleton_ref) {
 		}
 
 		if (indices->size() > 0) {
-			mesh_instance->set_light_mask(get_light_mask());
+			spine::BlendMode blend_mode = slot->getData().getBlendMode();
+			Ref<Material> custom_material = get_custom_material(slot);
+
+			// Use the custom material, or the default material
+			Ref<Material> material = custom_material.is_valid() ? custom_material : statics.default_materials[blend_mode];
 			size_t num_vertices = vertices->size() / 2;
+
+			if (batch_slots) {
+				// Start a new batch only when the render state changes.
+				if (batch_break || renderer_object != batch->renderer_object || blend_mode != batch_blend_mode || material != batch_material) {
+					if (batch) flush_batch(batch);
+					if (num_batches == mesh_instances.size()) {
+						if (in_threaded_update) {
+							// Nodes can only be added on the main thread, see threaded_update_end().
+							meshes_incomplete = true;
+							batch = nullptr;
+							break;
+						}
+						SpineMesh2D *new_instance = create_mesh_instance();
+						move_child(new_instance, mesh_instances[num_batches - 1]->get_index() + 1);
+					}
+					batch = mesh_instances[num_batches++];
+					batch->renderer_object = renderer_object;
+					batch->pending_material = material;
+					batch_blend_mode = blend_mode;
+					batch_material = material;
+					batch_vertices.clear();
+					batch_uvs.clear();
+					batch_colors.clear();
+					batch_indices.clear();
+					batch_break = false;
+				}
+				slot_batches[i] = num_batches - 1;
+
+				int first_vertex = (int) batch_vertices.size() / 2;
+				batch_vertices.addAll(*vertices);
+				batch_uvs.addAll(*uvs);
+				for (size_t j = 0; j < num_vertices; j++) {
+					batch_colors.add(Color(tint.r, tint.g, tint.b, tint.a));
+				}
+				for (size_t j = 0; j < indices->size(); j++) {
+					batch_indices.add(first_vertex + (*indices)[j]);
+				}
+				skeleton_clipper->clipEnd(*slot);
+				continue;
+			}
+
+#ifdef SPINE_GPU_SKINNING
+			mesh_instance->skinned = false;
+#endif
 			mesh_instance->vertices.resize((int) num_vertices);
 			memcpy(mesh_instance->vertices.ptrw(), vertices->buffer(), num_vertices * 2 * sizeof(float));
 			mesh_instance->uvs.resize((int) num_vertices);
@@ -952,58 +1276,224 @@ void SpineSprite::update_meshes(Ref<SpineSkeleton> skeleton_ref) {
 			}
 
 			mesh_instance->renderer_object = renderer_object;
+			mesh_instance->pending_material = material;
+		}
+		skeleton_clipper->clipEnd(*slot);
+	}
+	skeleton_clipper->clipEnd();
 
-			spine::BlendMode blend_mode = slot->getData().getBlendMode();
-			Ref<Material> custom_material;
-
-			// See if we have a slot node for this slot with a custom material
-			auto &nodes = slot_nodes[slot->getData().getIndex()];
-			if (nodes.size() > 0) {
-				auto slot_node = nodes[0];
-				if (slot_node) {
-					switch (blend_mode) {
-						case spine::BlendMode_Normal:
-							custom_material = slot_node->get_normal_material();
-							break;
-						case spine::BlendMode_Additive:
-							custom_material = slot_node->get_additive_material();
-							break;
-						case spine::BlendMode_Multiply:
-							custom_material = slot_node->get_multiply_material();
-							break;
-						case spine::BlendMode_Screen:
-							custom_material = slot_node->get_screen_material();
-							break;
-					}
-				}
+	if (batch_slots) {
+		if (batch) flush_batch(batch);
+		for (int i = num_batches; i < mesh_instances.size(); i++) {
+			mesh_instances[i]->renderer_object = nullptr;
+		}
+	}
+}
+
+Ref<Material> SpineSprite::get_custom_material(spine::Slot *slot) {
+	spine::BlendMode blend_mode = slot->getData().getBlendMode();
+	Ref<Material> custom_material;
+
+	// See if we have a slot node for this slot with a custom material
+	auto &nodes = slot_nodes[slot->getData().getIndex()];
+	if (nodes.size() > 0) {
+		auto slot_node = nodes[0];
+		if (slot_node) {
+			switch (blend_mode) {
+				case spine::BlendMode_Normal:
+					custom_material = slot_node->get_normal_material();
+					break;
+				case spine::BlendMode_Additive:
+					custom_material = slot_node->get_additive_material();
+					break;
+				case spine::BlendMode_Multiply:
+					custom_material = slot_node->get_multiply_material();
+					break;
+				case spine::BlendMode_Screen:
+					custom_material = slot_node->get_screen_material();
+					break;
 			}
+		}
+	}
 
-			// Else, check if we have a material on the sprite itself
-			if (!custom_material.is_valid()) {
-				switch (blend_mode) {
-					case spine::BlendMode_Normal:
-						custom_material = normal_material;
-						break;
-					case spine::BlendMode_Additive:
-						custom_material = additive_material;
-						break;
-					case spine::BlendMode_Multiply:
-						custom_material = multiply_material;
-						break;
-					case spine::BlendMode_Screen:
-						custom_material = screen_material;
-						break;
-				}
+	// Else, check if we have a material on the sprite itself
+	if (!custom_material.is_valid()) {
+		switch (blend_mode) {
+			case spine::BlendMode_Normal:
+				custom_material = normal_material;
+				break;
+			case spine::BlendMode_Additive:
+				custom_material = additive_material;
+				break;
+			case spine::BlendMode_Multiply:
+				custom_material = multiply_material;
+				break;
+			case spine::BlendMode_Screen:
+				custom_material = screen_material;
+				break;
+		}
+	}
+	return custom_material;
+}
+
+#ifdef SPINE_GPU_SKINNING
+bool SpineSprite::update_skinned_mesh(SpineMesh2D *mesh_instance, spine::Slot *slot, spine::MeshAttachment *mesh, const spine::Color &tint, SpineRendererObject *renderer_object) {
+	// Deform keys and clipping need the world vertices, custom materials bring their own shader.
+	if (mesh->getBones().size() == 0 || mesh->getTriangles().size() == 0) return false;
+	if (slot->getDeform().size() > 0 || skeleton_clipper->isClipping() || get_custom_material(slot).is_valid()) return false;
+
+	if (mesh_instance->skinned_attachment != mesh) {
+		spine::Vector<size_t> &bones = mesh->getBones();
+		spine::Vector<float> &vertices = mesh->getVertices();
+		mesh_instance->skinned_attachment = mesh;
+		mesh_instance->skinned_supported = true;
+		mesh_instance->skinned_bones.clear();
+		mesh_instance->skinned_reach = 0;
+		mesh_instance->skinned = false;
+		for (size_t v = 0, b = 0; v < bones.size();) {
+			int num_influences = (int) bones[v++];
+			if (num_influences > 4) mesh_instance->skinned_supported = false;
+			for (int k = 0; k < num_influences; k++, v++, b += 3) {
+				int bone = (int) bones[v];
+				if (!mesh_instance->skinned_bones.contains(bone)) mesh_instance->skinned_bones.add(bone);
+				mesh_instance->skinned_reach = MAX(mesh_instance->skinned_reach, MAX(ABS(vertices[b]), ABS(vertices[b + 1])));
 			}
+		}
+	}
+	if (!mesh_instance->skinned_supported) return false;
+
+	if (!mesh_instance->skinned) {
+		// Positions come from the shader, the arrays only change with the attachment.
+		int num_vertices = (int) mesh->getWorldVerticesLength() / 2;
+		int offset = skeleton_data_res->get_skinning_offset(mesh);
+		spine::Vector<unsigned short> &triangles = mesh->getTriangles();
+		mesh_instance->vertices.resize(num_vertices);
+		Vector2 *vertices = mesh_instance->vertices.ptrw();
+		for (int j = 0; j < num_vertices; ++j) {
+			vertices[j] = Vector2(offset + j, 0);
+		}
+		mesh_instance->uvs.resize(num_vertices);
+		memcpy(mesh_instance->uvs.ptrw(), mesh->getUVs().buffer(), num_vertices * 2 * sizeof(float));
+		mesh_instance->colors.resize(num_vertices);
+		mesh_instance->colors.fill(Color(1, 1, 1, 1));
+		mesh_instance->indices.resize((int) triangles.size());
+		for (int j = 0; j < (int) triangles.size(); ++j) {
+			mesh_instance->indices.set(j, triangles[j]);
+		}
+		mesh_instance->indices_changed = true;
+		mesh_instance->skinned = true;
+	}
 
-			// Set the custom material, or the default material
-			if (custom_material.is_valid()) mesh_instance->set_material(custom_material);
-			else
-				mesh_instance->set_material(statics.default_materials[slot->getData().getBlendMode()]);
+	// Every vertex is a weighted sum of points within reach of its bones.
+	spine::Vector<spine::Bone *> &bones = slot->getSkeleton().getBones();
+	float reach = mesh_instance->skinned_reach;
+	AABB aabb;
+	for (int j = 0; j < (int) mesh_instance->skinned_bones.size(); j++) {
+		spine::Bone *bone = bones[mesh_instance->skinned_bones[j]];
+		float extent_x = (ABS(bone->getA()) + ABS(bone->getB())) * reach;
+		float extent_y = (ABS(bone->getC()) + ABS(bone->getD())) * reach;
+		AABB bone_aabb(Vector3(bone->getWorldX() - extent_x, bone->getWorldY() - extent_y, 0), Vector3(extent_x * 2, extent_y * 2, 0));
+		if (j == 0) {
+			aabb = bone_aabb;
+		} else {
+			aabb.merge_with(bone_aabb);
 		}
-		skeleton_clipper->clipEnd(*slot);
 	}
-	skeleton_clipper->clipEnd();
+	mesh_instance->skinned_aabb = aabb;
+	mesh_instance->skinned_modulate = Color(tint.r, tint.g, tint.b, tint.a);
+	mesh_instance->skinned_blend_mode = slot->getData().getBlendMode();
+	mesh_instance->renderer_object = renderer_object;
+
+	if (!bone_data_changed) update_bone_data();
+	return true;
+}
+
+void SpineSprite::update_bone_data() {
+	spine::Vector<spine::Bone *> &bones = skeleton->get_spine_object()->getBones();
+	int num_texels = (int) bones.size() * 2;
+	bone_data_width = MIN(num_texels, SKINNING_TEXTURE_WIDTH);
+	bone_data_height = (num_texels + SKINNING_TEXTURE_WIDTH - 1) / SKINNING_TEXTURE_WIDTH;
+	bone_data.resize(bone_data_width * bone_data_height * 4 * sizeof(float));
+	float *data = (float *) bone_data.ptrw();
+	for (int i = 0; i < (int) bones.size(); i++, data += 8) {
+		spine::Bone *bone = bones[i];
+		data[0] = bone->getA();
+		data[1] = bone->getB();
+		data[2] = bone->getC();
+		data[3] = bone->getD();
+		data[4] = bone->getWorldX();
+		data[5] = bone->getWorldY();
+		data[6] = 0;
+		data[7] = 0;
+	}
+	bone_data_changed = true;
+}
+#endif
+
+void SpineSprite::finish_meshes() {
+#ifdef SPINE_GPU_SKINNING
+	auto &statics = SpineSpriteStatics::instance();
+	bool bone_texture_changed = false;
+	if (bone_data_changed) {
+		Ref<Image> image = Image::create_from_data(bone_data_width, bone_data_height, false, Image::FORMAT_RGBAF, bone_data);
+		if (bone_texture.is_valid() && bone_texture->get_width() == bone_data_width && bone_texture->get_height() == bone_data_height) {
+			bone_texture->update(image);
+		} else {
+			bone_texture = ImageTexture::create_from_image(image);
+			bone_texture_changed = true;
+		}
+		SpinePerformance::add(SpinePerformance::BYTES_UPLOADED, bone_data.size());
+		bone_data_changed = false;
+	}
+	bool skinning_texture_changed = false;
+	if (skeleton_data_res.is_valid()) {
+		Ref<ImageTexture> texture = skeleton_data_res->get_skinning_texture();
+		skinning_texture_changed = texture != skinning_texture;
+		skinning_texture = texture;
+	}
+	for (int i = 0; i < 4; i++) {
+		if (skinning_materials[i].is_null()) continue;
+		if (bone_texture_changed) skinning_materials[i]->set_shader_parameter(SNAME("bone_data"), bone_texture);
+		if (skinning_texture_changed) skinning_materials[i]->set_shader_parameter(SNAME("skin_data"), skinning_texture);
+	}
+#endif
+	int light_mask = get_light_mask();
+	for (int i = 0; i < mesh_instances.size(); i++) {
+		SpineMesh2D *mesh_instance = mesh_instances[i];
+		if (!mesh_instance->renderer_object) continue;
+		mesh_instance->set_light_mask(light_mask);
+#ifdef SPINE_GPU_SKINNING
+		if (mesh_instance->skinned) {
+			Ref<ShaderMaterial> &material = skinning_materials[mesh_instance->skinned_blend_mode];
+			if (material.is_null()) {
+				material.instantiate();
+				material->set_shader(statics.get_skinning_shader(mesh_instance->skinned_blend_mode));
+				material->set_shader_parameter(SNAME("bone_data"), bone_texture);
+				material->set_shader_parameter(SNAME("skin_data"), skinning_texture);
+			}
+			mesh_instance->pending_material = material;
+		}
+#endif
+		if (mesh_instance->get_material() != mesh_instance->pending_material) mesh_instance->set_material(mesh_instance->pending_material);
+	}
+	if (batch_slots) move_slot_nodes();
+}
+
+void SpineSprite::flush_batch(SpineMesh2D *mesh_instance) {
+	int num_vertices = (int) batch_vertices.size() / 2;
+	mesh_instance->vertices.resize(num_vertices);
+	memcpy(mesh_instance->vertices.ptrw(), batch_vertices.buffer(), num_vertices * 2 * sizeof(float));
+	mesh_instance->uvs.resize(num_vertices);
+	memcpy(mesh_instance->uvs.ptrw(), batch_uvs.buffer(), num_vertices * 2 * sizeof(float));
+	mesh_instance->colors.resize(num_vertices);
+	memcpy(mesh_instance->colors.ptrw(), batch_colors.buffer(), num_vertices * sizeof(Color));
+
+	int num_indices = (int) batch_indices.size();
+	if (mesh_instance->indices.size() != num_indices || (num_indices > 0 && memcmp(mesh_instance->indices.ptr(), batch_indices.buffer(), num_indices * sizeof(int)) != 0)) {
+		mesh_instance->indices.resize(num_indices);
+		memcpy(mesh_instance->indices.ptrw(), batch_indices.buffer(), num_indices * sizeof(int));
+		mesh_instance->indices_changed = true;
+	}
 }
 
 #ifdef SPINE_GODOT_EXTENSION
@@ -1032,7 +1522,7 @@ void SpineSprite::draw() {
 	if (!animation_state.is_valid() && !skeleton.is_valid()) return;
 	if (!Engine::get_singleton()->is_editor_hint() && !get_tree()->is_debugging_collisions_hint()) return;
 
-	auto statics = SpineSpriteStatics::instance();
+	auto &statics = SpineSpriteStatics::instance();
 
 #if VERSION_MAJOR > 3
 	RS::get_singleton()->canvas_item_clear(this->get_canvas_item());
@@ -1407,6 +1897,102 @@ void SpineSprite::set_screen_material(Ref<Material> mat) {
 	screen_material = mat;
 }
 
+bool SpineSprite::lod_step(float &delta) {
+	if (!lod_enabled || (lod_update_interval <= 1 && lod_max_fps <= 0 && lod_screen_size <= 0)) {
+		lod_skipped_time = 0;
+		return true;
+	}
+	lod_skipped_time += delta;
+	lod_skipped_frames++;
+
+	int interval = MAX(lod_update_interval, 1);
+	if (lod_screen_size > 0 && lod_local_size > 0 && is_inside_tree()) {
+		// Small on screen sprites update less often, up to 8 times.
+		Vector2 scale = get_global_transform_with_canvas().get_scale().abs();
+		float screen_size = lod_local_size * MAX(scale.x, scale.y);
+		if (screen_size < lod_screen_size) interval *= MIN((int) Math::ceil(lod_screen_size / MAX(screen_size, 1.0f)), 8);
+	}
+	if (lod_skipped_frames < interval) return false;
+	if (lod_max_fps > 0 && lod_skipped_time < 1.0f / lod_max_fps - 0.001f) return false;
+
+	delta = lod_skipped_time;
+	lod_skipped_time = 0;
+	lod_skipped_frames = 0;
+	return true;
+}
+
+void SpineSprite::set_lod_enabled(bool enabled) {
+	lod_enabled = enabled;
+}
+
+bool SpineSprite::is_lod_enabled() {
+	return lod_enabled;
+}
+
+void SpineSprite::set_lod_update_interval(int interval) {
+	lod_update_interval = MAX(interval, 1);
+}
+
+int SpineSprite::get_lod_update_interval() {
+	return lod_update_interval;
+}
+
+void SpineSprite::set_lod_max_fps(float max_fps) {
+	lod_max_fps = MAX(max_fps, 0.0f);
+}
+
+float SpineSprite::get_lod_max_fps() {
+	return lod_max_fps;
+}
+
+void SpineSprite::set_lod_screen_size(float screen_size) {
+	lod_screen_size = MAX(screen_size, 0.0f);
+}
+
+float SpineSprite::get_lod_screen_size() {
+	return lod_screen_size;
+}
+
+void SpineSprite::set_batch_slots(bool batch) {
+	if (batch_slots == batch) return;
+	batch_slots = batch;
+	if (!skeleton.is_valid()) return;
+	remove_meshes();
+	generate_meshes_for_slots(skeleton);
+	sort_slot_nodes();
+	update_meshes(skeleton);
+	finish_meshes();
+}
+
+bool SpineSprite::is_batch_slots() {
+	return batch_slots;
+}
+
+void SpineSprite::set_threaded(bool threaded_value) {
+	threaded = threaded_value;
+}
+
+bool SpineSprite::is_threaded() {
+	return threaded;
+}
+
+void SpineSprite::set_gpu_skinning(bool gpu_skinning_value) {
+	gpu_skinning = gpu_skinning_value;
+}
+
+bool SpineSprite::is_gpu_skinning() {
+	return gpu_skinning;
+}
+
+void SpineSprite::set_batched_pose(bool batched_pose_value) {
+	batched_pose = batched_pose_value;
+	if (skeleton.is_valid() && skeleton->get_spine_object()) skeleton->get_spine_object()->setBatchedPose(batched_pose);
+}
+
+bool SpineSprite::is_batched_pose() {
+	return batched_pose;
+}
+
 void SpineSprite::set_time_scale(float time_scale_value) {
 	this->time_scale = time_scale_value;
 }
@@ -41,6 +41,10 @@
 #include "scene/2d/node_2d.h"
 #endif
 
+#ifdef SPINE_GPU_SKINNING
+#include "scene/resources/material.h"
+#endif
+
 class SpineSlotNode;
 
 struct SpineRendererObject;
@@ -70,6 +74,22 @@ protected:
 	Vector<int> indices;
 #endif
 	SpineRendererObject *renderer_object;
+	// Applied on the main thread by SpineSprite::finish_meshes().
+	Ref<Material> pending_material;
+
+#ifdef SPINE_GPU_SKINNING
+	// Skinned meshes keep their arrays static and are drawn with the slot tint
+	// as modulate, the bone transforms come from SpineSprite::bone_texture.
+	// Vertex x holds the index of the vertex in the skeleton data's skinning texture.
+	bool skinned = false;
+	spine::MeshAttachment *skinned_attachment = nullptr;
+	bool skinned_supported = false;
+	spine::Vector<int> skinned_bones;
+	float skinned_reach = 0;
+	AABB skinned_aabb;
+	Color skinned_modulate;
+	spine::BlendMode skinned_blend_mode = spine::BlendMode_Normal;
+#endif
 
 	bool indices_changed;
 
@@ -135,6 +155,8 @@ class SpineSprite : public Node2D,
 	GDCLASS(SpineSprite, Node2D)
 
 	friend class SpineBone;
+	friend class SpineBenchmark;
+	friend class SpineSpriteServer;
 
 protected:
 	Ref<SpineSkeletonDataResource> skeleton_data_res;
@@ -143,6 +165,16 @@ protected:
 	SpineConstant::UpdateMode update_mode;
 	float time_scale;
 
+	// Level of detail, skipped process ticks accumulate their delta
+	// so the animation stays in sync.
+	bool lod_enabled;
+	int lod_update_interval;
+	float lod_max_fps;
+	float lod_screen_size;
+	float lod_skipped_time;
+	int lod_skipped_frames;
+	float lod_local_size;
+
 	String preview_skin;
 	String preview_animation;
 	bool preview_frame;
@@ -166,13 +198,48 @@ protected:
 
 	spine::Vector<spine::Vector<SpineSlotNode *>> slot_nodes;
 	Vector<SpineMesh2D *> mesh_instances;
+
+	// Batched rendering, consecutive slots sharing texture page, blend mode
+	// and material are concatenated into one mesh instance.
+	bool batch_slots;
+	spine::Vector<float> batch_vertices;
+	spine::Vector<float> batch_uvs;
+	spine::Vector<Color> batch_colors;
+	spine::Vector<int> batch_indices;
+	spine::Vector<int> slot_batches;
 	Ref<Material> normal_material;
 	Ref<Material> additive_material;
 	Ref<Material> multiply_material;
 	Ref<Material> screen_material;
 	spine::SkeletonClipping *skeleton_clipper;
+	spine::Vector<float> scratch_vertices;
 	bool modified_bones;
 
+	// Threaded updates, the skeleton is posed and its vertices are generated
+	// on the SpineSpriteServer workers, listener signals are raised afterwards.
+	// Sprites with animation_*, before_animation_state_apply or before_world_transforms_change
+	// connections fall back to update_skeleton() on the main thread.
+	bool threaded;
+	bool update_queued;
+	float queued_delta;
+	float update_delta;
+	bool update_visible;
+	bool in_threaded_update;
+	bool meshes_incomplete;
+
+	bool gpu_skinning;
+	bool batched_pose;
+#ifdef SPINE_GPU_SKINNING
+	// One material per blend mode, shared by all skinned meshes of the sprite.
+	Ref<ShaderMaterial> skinning_materials[4];
+	Ref<ImageTexture> skinning_texture;
+	Ref<ImageTexture> bone_texture;
+	Vector<uint8_t> bone_data;
+	int bone_data_width;
+	int bone_data_height;
+	bool bone_data_changed;
+#endif
+
 	static void _bind_methods();
 	void _notification(int what);
 	void _get_property_list(List<PropertyInfo> *list) const;
@@ -180,10 +247,26 @@ protected:
 	bool _set(const StringName &property, const Variant &value);
 
 	void generate_meshes_for_slots(Ref<SpineSkeleton> skeleton_ref);
+	SpineMesh2D *create_mesh_instance();
 	void remove_meshes();
 	void sort_slot_nodes();
+	void move_slot_nodes();
 	void update_meshes(Ref<SpineSkeleton> skeleton_ref);
+	void flush_batch(SpineMesh2D *mesh_instance);
+	void finish_meshes();
+	Ref<Material> get_custom_material(spine::Slot *slot);
+#ifdef SPINE_GPU_SKINNING
+	bool update_skinned_mesh(SpineMesh2D *mesh_instance, spine::Slot *slot, spine::MeshAttachment *mesh, const spine::Color &tint, SpineRendererObject *renderer_object);
+	void update_bone_data();
+#endif
+	bool has_spine_objects();
+	void update_lod_size();
+	void queue_update_skeleton(float delta);
+	bool threaded_update_begin();
+	void threaded_update_evaluate();
+	void threaded_update_end();
 	void set_modified_bones() { modified_bones = true; }
+	bool lod_step(float &delta);
 	void draw();
 	void draw_bone(spine::Bone *bone, const Color &color);
 
@@ -235,6 +318,38 @@ public:
 
 	float get_time_scale();
 
+	void set_lod_enabled(bool enabled);
+
+	bool is_lod_enabled();
+
+	void set_lod_update_interval(int interval);
+
+	int get_lod_update_interval();
+
+	void set_lod_max_fps(float max_fps);
+
+	float get_lod_max_fps();
+
+	void set_lod_screen_size(float screen_size);
+
+	float get_lod_screen_size();
+
+	void set_batch_slots(bool batch);
+
+	bool is_batch_slots();
+
+	void set_threaded(bool threaded);
+
+	bool is_threaded();
+
+	void set_gpu_skinning(bool gpu_skinning);
+
+	bool is_gpu_skinning();
+
+	void set_batched_pose(bool batched_pose);
+
+	bool is_batched_pose();
+
 	bool get_debug_root() { return debug_root; }
 
 	void set_debug_root(bool root) { debug_root = root; }
@@ -0,0 +1,131 @@
+/******************************************************************************
+ * Spine Runtimes License Agreement
+ * Last updated April 5, 2025. Replaces all prior versions.
+ *
+ * Copyright (c) 2013-2025, Esoteric Software LLC
+ *
+ * Integration of the Spine Runtimes into software or otherwise creating
+ * derivative works of the Spine Runtimes is permitted under the terms and
+ * conditions of Section 2 of the Spine Editor License Agreement:
+ * http://esotericsoftware.com/spine-editor-license
+ *
+ * Otherwise, it is permitted to integrate the Spine Runtimes into software
+ * or otherwise create derivative works of the Spine Runtimes (collectively,
+ * "Products"), provided that each user of the Products must obtain their own
+ * Spine Editor license and redistribution of the Products in any form must
+ * include this license and copyright notice.
+ *
+ * THE SPINE RUNTIMES ARE PROVIDED BY ESOTERIC SOFTWARE LLC "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ESOTERIC SOFTWARE LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES,
+ * BUSINESS INTERRUPTION, OR LOSS OF USE, DATA, OR PROFITS) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THE SPINE RUNTIMES, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#include "SpineSpriteServer.h"
+
+#if defined(SPINE_GODOT_EXTENSION) || VERSION_MAJOR > 3
+
+#include "SpineSprite.h"
+
+#ifdef SPINE_GODOT_EXTENSION
+#include <godot_cpp/classes/worker_thread_pool.hpp>
+#else
+#include "core/object/worker_thread_pool.h"
+#endif
+
+SpineSpriteServer *SpineSpriteServer::singleton = nullptr;
+
+void SpineSpriteServer::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("flush"), &SpineSpriteServer::flush);
+	ClassDB::bind_method(D_METHOD("set_use_threads", "use_threads"), &SpineSpriteServer::set_use_threads);
+	ClassDB::bind_method(D_METHOD("is_using_threads"), &SpineSpriteServer::is_using_threads);
+	ClassDB::bind_method(D_METHOD("set_min_batch_size", "min_batch_size"), &SpineSpriteServer::set_min_batch_size);
+	ClassDB::bind_method(D_METHOD("get_min_batch_size"), &SpineSpriteServer::get_min_batch_size);
+
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "use_threads"), "set_use_threads", "is_using_threads");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "min_batch_size"), "set_min_batch_size", "get_min_batch_size");
+}
+
+void SpineSpriteServer::queue_sprite(SpineSprite *sprite) {
+	queued_sprites.push_back(sprite->get_instance_id());
+	if (!flush_queued) {
+		flush_queued = true;
+		call_deferred(SNAME("flush"));
+	}
+}
+
+void SpineSpriteServer::evaluate_sprite(uint32_t index, SpineSprite **sprites) {
+	sprites[index]->threaded_update_evaluate();
+}
+
+#ifdef SPINE_GODOT_EXTENSION
+void SpineSpriteServer::evaluate_batch_sprite(uint32_t index) {
+	evaluate_sprite(index, batch.ptr());
+}
+#endif
+
+void SpineSpriteServer::flush() {
+	flush_queued = false;
+	if (queued_sprites.size() == 0) return;
+
+	// Sprites queued from signal handlers below go to the next flush.
+	LocalVector<ObjectID> sprites = queued_sprites;
+	queued_sprites.clear();
+
+	batch.clear();
+	for (uint32_t i = 0; i < sprites.size(); i++) {
+		SpineSprite *sprite = Object::cast_to<SpineSprite>(ObjectDB::get_instance(sprites[i]));
+		if (!sprite) continue;
+		if (sprite->threaded_update_begin()) batch.push_back(sprite);
+	}
+
+	if (use_threads && (int) batch.size() >= min_batch_size) {
+#ifdef SPINE_GODOT_EXTENSION
+		int64_t group = WorkerThreadPool::get_singleton()->add_group_task(callable_mp(this, &SpineSpriteServer::evaluate_batch_sprite), batch.size(), -1, true, "SpineSpriteServer");
+#else
+		WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_template_group_task(this, &SpineSpriteServer::evaluate_sprite, batch.ptr(), batch.size(), -1, true, SNAME("SpineSpriteServer"));
+#endif
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+	} else {
+		for (uint32_t i = 0; i < batch.size(); i++) {
+			evaluate_sprite(i, batch.ptr());
+		}
+	}
+
+	for (uint32_t i = 0; i < batch.size(); i++) {
+		batch[i]->threaded_update_end();
+	}
+	batch.clear();
+}
+
+void SpineSpriteServer::set_use_threads(bool use_threads_value) {
+	use_threads = use_threads_value;
+}
+
+bool SpineSpriteServer::is_using_threads() {
+	return use_threads;
+}
+
+void SpineSpriteServer::set_min_batch_size(int min_batch_size_value) {
+	min_batch_size = MAX(min_batch_size_value, 1);
+}
+
+int SpineSpriteServer::get_min_batch_size() {
+	return min_batch_size;
+}
+
+SpineSpriteServer::SpineSpriteServer() : flush_queued(false), use_threads(true), min_batch_size(4) {
+	singleton = this;
+}
+
+SpineSpriteServer::~SpineSpriteServer() {
+	if (singleton == this) singleton = nullptr;
+}
+
+#endif
@@ -0,0 +1,89 @@
+/******************************************************************************
+ * Spine Runtimes License Agreement
+ * Last updated April 5, 2025. Replaces all prior versions.
+ *
+ * Copyright (c) 2013-2025, Esoteric Software LLC
+ *
+ * Integration of the Spine Runtimes into software or otherwise creating
+ * derivative works of the Spine Runtimes is permitted under the terms and
+ * conditions of Section 2 of the Spine Editor License Agreement:
+ * http://esotericsoftware.com/spine-editor-license
+ *
+ * Otherwise, it is permitted to integrate the Spine Runtimes into software
+ * or otherwise create derivative works of the Spine Runtimes (collectively,
+ * "Products"), provided that each user of the Products must obtain their own
+ * Spine Editor license and redistribution of the Products in any form must
+ * include this license and copyright notice.
+ *
+ * THE SPINE RUNTIMES ARE PROVIDED BY ESOTERIC SOFTWARE LLC "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ESOTERIC SOFTWARE LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES,
+ * BUSINESS INTERRUPTION, OR LOSS OF USE, DATA, OR PROFITS) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THE SPINE RUNTIMES, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#pragma once
+
+#include "SpineCommon.h"
+
+#if defined(SPINE_GODOT_EXTENSION) || VERSION_MAJOR > 3
+
+#ifdef SPINE_GODOT_EXTENSION
+#include <godot_cpp/classes/object.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+#else
+#include "core/object/object.h"
+#include "core/templates/local_vector.h"
+#endif
+
+class SpineSprite;
+
+// Gathers threaded sprites queued for a skeleton update during the frame and
+// updates them in one deferred batch. Animation state, world transforms and
+// vertices are computed on the WorkerThreadPool, signals, node changes and
+// mesh uploads stay on the main thread, in the order the sprites were queued.
+class SpineSpriteServer : public Object {
+	GDCLASS(SpineSpriteServer, Object)
+
+	static SpineSpriteServer *singleton;
+
+	LocalVector<ObjectID> queued_sprites;
+	LocalVector<SpineSprite *> batch;
+	bool flush_queued;
+	bool use_threads;
+	int min_batch_size;
+
+	void evaluate_sprite(uint32_t index, SpineSprite **sprites);
+#ifdef SPINE_GODOT_EXTENSION
+	void evaluate_batch_sprite(uint32_t index);
+#endif
+
+protected:
+	static void _bind_methods();
+
+public:
+	static SpineSpriteServer *get_singleton() { return singleton; }
+
+	void queue_sprite(SpineSprite *sprite);
+
+	void flush();
+
+	void set_use_threads(bool use_threads);
+
+	bool is_using_threads();
+
+	void set_min_batch_size(int min_batch_size);
+
+	int get_min_batch_size();
+
+	SpineSpriteServer();
+
+	~SpineSpriteServer();
+};
+
+#endif
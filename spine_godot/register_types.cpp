@@ -55,12 +55,22 @@
 #include "SpineConstant.h"
 #include "SpineSlotNode.h"
 #include "SpineBoneNode.h"
+#include "SpineBenchmark.h"
+#include "SpineSpriteServer.h"
+#ifdef SPINE_GODOT_EXTENSION
+#include <godot_cpp/classes/engine.hpp>
+#elif VERSION_MAJOR > 3
+#include "core/config/engine.h"
+#endif
 #include "spine/Bone.h"
 
 static SpineAtlasResourceFormatLoader *atlas_loader;
 static SpineAtlasResourceFormatSaver *atlas_saver;
 static SpineSkeletonFileResourceFormatLoader *skeleton_file_loader;
 static SpineSkeletonFileResourceFormatSaver *skeleton_file_saver;
+#if defined(SPINE_GODOT_EXTENSION) || VERSION_MAJOR > 3
+static SpineSpriteServer *sprite_server;
+#endif
 
 #ifdef TOOLS_ENABLED
 #ifdef SPINE_GODOT_EXTENSION
@@ -149,6 +159,17 @@ void register_spine_godot_types() {
 #ifndef SPINE_GODOT_EXTENSION
 	GDREGISTER_CLASS(SpineAnimationTrack);
 #endif
+#if defined(SPINE_GODOT_EXTENSION) || VERSION_MAJOR > 3
+	GDREGISTER_CLASS(SpineBenchmark);
+	GDREGISTER_CLASS(SpineSpriteServer);
+
+	sprite_server = memnew(SpineSpriteServer);
+#ifdef SPINE_GODOT_EXTENSION
+	Engine::get_singleton()->register_singleton("SpineSpriteServer", sprite_server);
+#else
+	Engine::get_singleton()->add_singleton(Engine::Singleton("SpineSpriteServer", sprite_server));
+#endif
+#endif
 
 #ifdef SPINE_GODOT_EXTENSION
 	atlas_loader = memnew(SpineAtlasResourceFormatLoader);
@@ -195,6 +216,15 @@ void register_spine_godot_types() {
 void uninitialize_spine_godot_module(ModuleInitializationLevel level) {
 	if (level == MODULE_INITIALIZATION_LEVEL_SCENE) {
 		SpineSprite::clear_statics();
+		if (sprite_server) {
+#ifdef SPINE_GODOT_EXTENSION
+			Engine::get_singleton()->unregister_singleton("SpineSpriteServer");
+#else
+			Engine::get_singleton()->remove_singleton("SpineSpriteServer");
+#endif
+			memdelete(sprite_server);
+			sprite_server = nullptr;
+		}
 		return;
 	}
 	if (level != MODULE_INITIALIZATION_LEVEL_CORE) return;
@@ -386,6 +386,9 @@ namespace spine {
 		void disableQueue();
 		void enableQueue();
 
+		/// Raises the events queued while the queue was disabled.
+		void drainQueue();
+
 	private:
 		static const int Subsequent = 0;
 		static const int First = 1;
@@ -0,0 +1,199 @@
+/******************************************************************************
+ * Spine Runtimes License Agreement
+ * Last updated January 1, 2020. Replaces all prior versions.
+ *
+ * Copyright (c) 2013-2020, Esoteric Software LLC
+ *
+ * Integration of the Spine Runtimes into software or otherwise creating
+ * derivative works of the Spine Runtimes is permitted under the terms and
+ * conditions of Section 2 of the Spine Editor License Agreement:
+ * http://esotericsoftware.com/spine-editor-license
+ *
+ * Otherwise, it is permitted to integrate the Spine Runtimes into software
+ * or otherwise create derivative works of the Spine Runtimes (collectively,
+ * "Products"), provided that each user of the Products must obtain their own
+ * Spine Editor license and redistribution of the Products in any form must
+ * include this license and copyright notice.
+ *
+ * THE SPINE RUNTIMES ARE PROVIDED BY ESOTERIC SOFTWARE LLC "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ESOTERIC SOFTWARE LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES,
+ * BUSINESS INTERRUPTION, OR LOSS OF USE, DATA, OR PROFITS) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THE SPINE RUNTIMES, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#ifndef Spine_Simd_h
+#define Spine_Simd_h
+
+// Minimal 4-lane float abstraction for the vertex transform kernels.
+// Define SPINE_NO_SIMD to force the scalar fallback.
+#if !defined(SPINE_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SPINE_SIMD_SSE2
+#include <emmintrin.h>
+#elif !defined(SPINE_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define SPINE_SIMD_NEON
+#include <arm_neon.h>
+#else
+#define SPINE_SIMD_SCALAR
+#endif
+
+#include <stddef.h>
+#include <math.h>
+
+namespace spine {
+namespace simd {
+#if defined(SPINE_SIMD_SSE2)
+	typedef __m128 Float4;
+
+	inline Float4 load(const float *values) { return _mm_loadu_ps(values); }
+
+	inline Float4 splat(float value) { return _mm_set1_ps(value); }
+
+	inline Float4 add(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+
+	inline Float4 sub(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+
+	inline Float4 mul(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+
+	inline void store(float *values, Float4 a) { _mm_storeu_ps(values, a); }
+
+	/// Loads 4 x, y pairs into separate x and y lanes.
+	inline void loadPairs(const float *values, Float4 &x, Float4 &y) {
+		__m128 low = _mm_loadu_ps(values), high = _mm_loadu_ps(values + 4);
+		x = _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+		y = _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+	}
+
+	/// Stores x and y lanes as 4 consecutive x, y pairs.
+	inline void storePairs(float *values, Float4 x, Float4 y) {
+		_mm_storeu_ps(values, _mm_unpacklo_ps(x, y));
+		_mm_storeu_ps(values + 4, _mm_unpackhi_ps(x, y));
+	}
+#elif defined(SPINE_SIMD_NEON)
+	typedef float32x4_t Float4;
+
+	inline Float4 load(const float *values) { return vld1q_f32(values); }
+
+	inline Float4 splat(float value) { return vdupq_n_f32(value); }
+
+	inline Float4 add(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+
+	inline Float4 sub(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+
+	// Separate multiply and add, vmlaq_f32 may fuse and round differently than the scalar path.
+	inline Float4 mul(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+
+	inline void store(float *values, Float4 a) { vst1q_f32(values, a); }
+
+	inline void loadPairs(const float *values, Float4 &x, Float4 &y) {
+		float32x4x2_t pairs = vld2q_f32(values);
+		x = pairs.val[0];
+		y = pairs.val[1];
+	}
+
+	inline void storePairs(float *values, Float4 x, Float4 y) {
+		float32x4x2_t pairs = {{x, y}};
+		vst2q_f32(values, pairs);
+	}
+#else
+	struct Float4 {
+		float v[4];
+	};
+
+	inline Float4 load(const float *values) {
+		Float4 r = {{values[0], values[1], values[2], values[3]}};
+		return r;
+	}
+
+	inline Float4 splat(float value) {
+		Float4 r = {{value, value, value, value}};
+		return r;
+	}
+
+	inline Float4 add(Float4 a, Float4 b) {
+		Float4 r = {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};
+		return r;
+	}
+
+	inline Float4 sub(Float4 a, Float4 b) {
+		Float4 r = {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}};
+		return r;
+	}
+
+	inline Float4 mul(Float4 a, Float4 b) {
+		Float4 r = {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}};
+		return r;
+	}
+
+	inline void store(float *values, Float4 a) {
+		values[0] = a.v[0];
+		values[1] = a.v[1];
+		values[2] = a.v[2];
+		values[3] = a.v[3];
+	}
+
+	inline void loadPairs(const float *values, Float4 &x, Float4 &y) {
+		for (int i = 0; i < 4; i++) {
+			x.v[i] = values[i * 2];
+			y.v[i] = values[i * 2 + 1];
+		}
+	}
+
+	inline void storePairs(float *values, Float4 x, Float4 y) {
+		for (int i = 0; i < 4; i++) {
+			values[i * 2] = x.v[i];
+			values[i * 2 + 1] = y.v[i];
+		}
+	}
+#endif
+
+	/// Stores x and y lanes as 4 x, y pairs that are stride floats apart.
+	inline void storePairs(float *values, Float4 x, Float4 y, size_t stride) {
+		if (stride == 2) {
+			storePairs(values, x, y);
+			return;
+		}
+		float xs[4], ys[4];
+		store(xs, x);
+		store(ys, y);
+		for (int i = 0; i < 4; i++, values += stride) {
+			values[0] = xs[i];
+			values[1] = ys[i];
+		}
+	}
+
+	/// Returns a * x + b * y + t per lane, in the same order of operations as the scalar transforms.
+	inline Float4 transform(Float4 x, Float4 y, Float4 a, Float4 b, Float4 t) {
+		return add(add(mul(x, a), mul(y, b)), t);
+	}
+
+	/// Sine and cosine of 4 angles in degrees. The angles are reduced to [-45, 45] degrees around
+	/// the nearest quarter turn, followed by the single precision minimax polynomials from Cephes.
+	/// Within about 1e-6 of MathUtil::sinDeg() and MathUtil::cosDeg(), but not bit identical.
+	inline void sinCosDeg(const float *degrees, float *sines, float *cosines) {
+		float reduced[4], sinSign[4], cosSign[4], swap[4];
+		for (int i = 0; i < 4; i++) {
+			float quarter = floorf(degrees[i] * (1.0f / 90) + 0.5f);
+			reduced[i] = (degrees[i] - quarter * 90) * (3.14159265358979323846f / 180);
+			int quadrant = (int) quarter & 3;
+			swap[i] = (float) (quadrant & 1);
+			sinSign[i] = quadrant >= 2 ? -1.0f : 1.0f;
+			cosSign[i] = quadrant == 1 || quadrant == 2 ? -1.0f : 1.0f;
+		}
+		Float4 x = load(reduced), z = mul(x, x);
+		Float4 s = add(mul(mul(sub(mul(add(mul(splat(-1.9515295891e-4f), z), splat(8.3321608736e-3f)), z), splat(1.6666654611e-1f)), z), x), x);
+		Float4 c = add(sub(mul(mul(add(mul(sub(mul(splat(2.443315711809948e-5f), z), splat(1.388731625493765e-3f)), z), splat(4.166664568298827e-2f)), z), z), mul(splat(0.5f), z)), splat(1.0f));
+		// Odd quadrants swap sine and cosine, one of the products is always exactly zero.
+		Float4 keep = sub(splat(1.0f), load(swap));
+		store(sines, mul(load(sinSign), add(mul(s, keep), mul(c, load(swap)))));
+		store(cosines, mul(load(cosSign), add(mul(c, keep), mul(s, load(swap)))));
+	}
+}
+}
+
+#endif /* Spine_Simd_h */
@@ -58,6 +58,12 @@ class Attachment;
 class SP_API Skeleton : public SpineObject {
 	friend class AnimationState;
 
+	friend class Bone;
+
+	friend class PathConstraint;
+
+	friend class TransformConstraint;
+
 	friend class SkeletonBounds;
 
 	friend class SkeletonClipping;
@@ -104,6 +110,13 @@ public:
 	/// Updates the world transform for each bone and applies constraints.
 	void updateWorldTransform();
 
+	/// If true, updateWorldTransform() computes runs of unconstrained TransformMode_Normal bones from a structure of arrays
+	/// pose with batched sine and cosine, see spine/Simd.h. The approximated sine and cosine make the results differ slightly
+	/// from the per bone path.
+	void setBatchedPose(bool inValue);
+
+	bool isBatchedPose();
+
 	/// Sets the bones, constraints, and slots to their setup pose values.
 	void setToSetupPose();
 
@@ -170,6 +183,10 @@ public:
 
 	Vector<Bone *> &getBones();
 
+	/// Returns the world transforms of all bones as structure of arrays: a, b, c, d, worldX and worldY,
+	/// each getBones().size() floats long. Repacked lazily after the world transforms changed.
+	float *getBoneMatrices();
+
 	Vector<Updatable *> &getUpdateCacheList();
 
 	Vector<Slot *> &getSlots();
@@ -223,6 +240,12 @@ private:
 	float _time;
 	float _scaleX, _scaleY;
 	float _x, _y;
+	Vector<float> _boneMatrices;
+	bool _boneMatricesDirty;
+	bool _batchedPose;
+	Vector<size_t> _poseRuns;
+	Vector<int> _poseParents;
+	Vector<float> _pose;
 
 	void sortIkConstraint(IkConstraint *constraint);
 
@@ -237,6 +260,10 @@ private:
 	void sortBone(Bone *bone);
 
 	static void sortReset(Vector<Bone *> &bones);
+
+	void updatePoseRuns();
+
+	void updatePoseRun(size_t start, size_t count);
 };
 }
 
@@ -62,6 +62,12 @@ namespace spine {
 		void computeWorldVertices(Slot& slot, size_t start, size_t count, float* worldVertices, size_t offset, size_t stride = 2);
 		void computeWorldVertices(Slot& slot, size_t start, size_t count, Vector<float>& worldVertices, size_t offset, size_t stride = 2);
 
+		/// Reference implementation of computeWorldVertices, one vertex at a time.
+		void computeWorldVerticesScalar(Slot& slot, size_t start, size_t count, float* worldVertices, size_t offset, size_t stride = 2);
+
+		/// Transforms 4 vertices at a time, see spine/Simd.h. Used by computeWorldVertices.
+		void computeWorldVerticesSimd(Slot& slot, size_t start, size_t count, float* worldVertices, size_t offset, size_t stride = 2);
+
 		/// Gets a unique ID for this attachment.
 		int getId();
 
@@ -102,6 +102,7 @@ void Bone::updateWorldTransform(float x, float y, float rotation, float scaleX,
 	_ashearX = shearX;
 	_ashearY = shearY;
 	_appliedValid = true;
+	_skeleton._boneMatricesDirty = true;
 
 	if (!parent) { /* Root bone. */
 		float rotationY = rotation + 90 + shearY;
@@ -268,6 +269,7 @@ void Bone::rotateWorld(float degrees) {
 	_d = sin * b + cos * d;
 
 	_appliedValid = false;
+	_skeleton._boneMatricesDirty = true;
 }
 
 float Bone::getWorldToLocalRotationX() {
@@ -436,6 +438,7 @@ float Bone::getA() {
 
 void Bone::setA(float inValue) {
 	_a = inValue;
+	_skeleton._boneMatricesDirty = true;
 }
 
 float Bone::getB() {
@@ -444,6 +447,7 @@ float Bone::getB() {
 
 void Bone::setB(float inValue) {
 	_b = inValue;
+	_skeleton._boneMatricesDirty = true;
 }
 
 float Bone::getC() {
@@ -452,6 +456,7 @@ float Bone::getC() {
 
 void Bone::setC(float inValue) {
 	_c = inValue;
+	_skeleton._boneMatricesDirty = true;
 }
 
 float Bone::getD() {
@@ -460,6 +465,7 @@ float Bone::getD() {
 
 void Bone::setD(float inValue) {
 	_d = inValue;
+	_skeleton._boneMatricesDirty = true;
 }
 
 float Bone::getWorldX() {
@@ -468,6 +474,7 @@ float Bone::getWorldX() {
 
 void Bone::setWorldX(float inValue) {
 	_worldX = inValue;
+	_skeleton._boneMatricesDirty = true;
 }
 
 float Bone::getWorldY() {
@@ -476,6 +483,7 @@ float Bone::getWorldY() {
 
 void Bone::setWorldY(float inValue) {
 	_worldY = inValue;
+	_skeleton._boneMatricesDirty = true;
 }
 
 float Bone::getWorldRotationX() {
@@ -204,6 +204,8 @@ void PathConstraint::update() {
 
 		bone._appliedValid = false;
 	}
+	// The world transforms were written directly, see Skeleton::getBoneMatrices().
+	_target->getBone().getSkeleton()._boneMatricesDirty = true;
 }
 
 int PathConstraint::getOrder() {
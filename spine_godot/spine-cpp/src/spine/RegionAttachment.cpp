@@ -34,6 +34,7 @@
 #include <spine/RegionAttachment.h>
 
 #include <spine/Bone.h>
+#include <spine/Simd.h>
 
 #include <assert.h>
 
@@ -131,32 +132,13 @@ void RegionAttachment::computeWorldVertices(Bone &bone, Vector<float> &worldVert
 }
 
 void RegionAttachment::computeWorldVertices(Bone &bone, float* worldVertices, size_t offset, size_t stride) {
-	float x = bone.getWorldX(), y = bone.getWorldY();
-	float a = bone.getA(), b = bone.getB(), c = bone.getC(), d = bone.getD();
-	float offsetX, offsetY;
-
-	offsetX = _vertexOffset[BRX];
-	offsetY = _vertexOffset[BRY];
-	worldVertices[offset] = offsetX * a + offsetY * b + x; // br
-	worldVertices[offset + 1] = offsetX * c + offsetY * d + y;
-	offset += stride;
-
-	offsetX = _vertexOffset[BLX];
-	offsetY = _vertexOffset[BLY];
-	worldVertices[offset] = offsetX * a + offsetY * b + x; // bl
-	worldVertices[offset + 1] = offsetX * c + offsetY * d + y;
-	offset += stride;
-
-	offsetX = _vertexOffset[ULX];
-	offsetY = _vertexOffset[ULY];
-	worldVertices[offset] = offsetX * a + offsetY * b + x; // ul
-	worldVertices[offset + 1] = offsetX * c + offsetY * d + y;
-	offset += stride;
-
-	offsetX = _vertexOffset[URX];
-	offsetY = _vertexOffset[URY];
-	worldVertices[offset] = offsetX * a + offsetY * b + x; // ur
-	worldVertices[offset + 1] = offsetX * c + offsetY * d + y;
+	// All 4 corners at once, in the order br, bl, ul, ur.
+	float offsetX[4] = {_vertexOffset[BRX], _vertexOffset[BLX], _vertexOffset[ULX], _vertexOffset[URX]};
+	float offsetY[4] = {_vertexOffset[BRY], _vertexOffset[BLY], _vertexOffset[ULY], _vertexOffset[URY]};
+	simd::Float4 x = simd::load(offsetX), y = simd::load(offsetY);
+	simd::Float4 worldX = simd::transform(x, y, simd::splat(bone.getA()), simd::splat(bone.getB()), simd::splat(bone.getWorldX()));
+	simd::Float4 worldY = simd::transform(x, y, simd::splat(bone.getC()), simd::splat(bone.getD()), simd::splat(bone.getWorldY()));
+	simd::storePairs(worldVertices + offset, worldX, worldY, stride);
 }
 
 float RegionAttachment::getX() {
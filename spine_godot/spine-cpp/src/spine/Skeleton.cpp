@@ -52,11 +52,34 @@
 #include <spine/PathAttachment.h>
 
 #include <spine/ContainerUtil.h>
+#include <spine/Simd.h>
 
 #include <float.h>
 
 using namespace spine;
 
+// Arrays of the structure of arrays pose, each one _updateCache.size() + 4 floats long so
+// the 4 lane kernels can run past the end of a bone run.
+enum PoseArray {
+	Pose_X,
+	Pose_Y,
+	Pose_AngleX,
+	Pose_AngleY,
+	Pose_ScaleX,
+	Pose_ScaleY,
+	Pose_LocalA,
+	Pose_LocalB,
+	Pose_LocalC,
+	Pose_LocalD,
+	Pose_A,
+	Pose_B,
+	Pose_C,
+	Pose_D,
+	Pose_WorldX,
+	Pose_WorldY,
+	Pose_Count
+};
+
 Skeleton::Skeleton(SkeletonData *skeletonData) :
 		_data(skeletonData),
 		_skin(NULL),
@@ -65,7 +88,9 @@ Skeleton::Skeleton(SkeletonData *skeletonData) :
 		_scaleX(1),
 		_scaleY(1),
 		_x(0),
-		_y(0) {
+		_y(0),
+		_boneMatricesDirty(true),
+		_batchedPose(false) {
 	_bones.ensureCapacity(_data->getBones().size());
 	for (size_t i = 0; i < _data->getBones().size(); ++i) {
 		BoneData *data = _data->getBones()[i];
@@ -195,6 +220,124 @@ void Skeleton::updateCache() {
 	for (i = 0; i < n; ++i) {
 		sortBone(_bones[i]);
 	}
+
+	updatePoseRuns();
+}
+
+void Skeleton::updatePoseRuns() {
+	size_t n = _updateCache.size();
+	_poseRuns.setSize(n, 0);
+	_poseParents.setSize(n, -1);
+	_pose.setSize((n + 4) * Pose_Count, 0);
+
+	// Bones can appear more than once in the update cache, only the latest entry holds the current world transform.
+	Vector<int> cacheIndices;
+	cacheIndices.setSize(_bones.size(), -1);
+	for (size_t i = 0; i < n;) {
+		size_t start = i;
+		for (; i < n; ++i) {
+			Updatable *updatable = _updateCache[i];
+			if (!updatable->getRTTI().isExactly(Bone::rtti)) break;
+			Bone *bone = (Bone *) updatable;
+			if (!bone->_parent || bone->_data.getTransformMode() != TransformMode_Normal) break;
+			int parentIndex = cacheIndices[bone->_parent->_data.getIndex()];
+			_poseParents[i] = parentIndex >= (int) start ? parentIndex : -1;
+			_poseRuns[i] = 0;
+			cacheIndices[bone->_data.getIndex()] = (int) i;
+		}
+		if (i > start) {
+			_poseRuns[start] = i - start;
+			continue;
+		}
+
+		// Roots, other transform modes and constraints use their own update().
+		Updatable *updatable = _updateCache[i];
+		if (updatable->getRTTI().isExactly(Bone::rtti)) cacheIndices[((Bone *) updatable)->_data.getIndex()] = (int) i;
+		_poseRuns[i] = 0;
+		_poseParents[i] = -1;
+		++i;
+	}
+}
+
+void Skeleton::updatePoseRun(size_t start, size_t count) {
+	size_t stride = _updateCache.size() + 4;
+	float *pose = _pose.buffer() + start;
+	float *x = pose + Pose_X * stride, *y = pose + Pose_Y * stride;
+	float *angleX = pose + Pose_AngleX * stride, *angleY = pose + Pose_AngleY * stride;
+	float *scaleX = pose + Pose_ScaleX * stride, *scaleY = pose + Pose_ScaleY * stride;
+	float *la = pose + Pose_LocalA * stride, *lb = pose + Pose_LocalB * stride;
+	float *lc = pose + Pose_LocalC * stride, *ld = pose + Pose_LocalD * stride;
+	float *a = pose + Pose_A * stride, *b = pose + Pose_B * stride, *c = pose + Pose_C * stride, *d = pose + Pose_D * stride;
+	float *worldX = pose + Pose_WorldX * stride, *worldY = pose + Pose_WorldY * stride;
+
+	// Gather the local pose, which is also the applied pose.
+	for (size_t i = 0; i < count; ++i) {
+		Bone &bone = *(Bone *) _updateCache[start + i];
+		bone._ax = bone._x;
+		bone._ay = bone._y;
+		bone._arotation = bone._rotation;
+		bone._ascaleX = bone._scaleX;
+		bone._ascaleY = bone._scaleY;
+		bone._ashearX = bone._shearX;
+		bone._ashearY = bone._shearY;
+		bone._appliedValid = true;
+		x[i] = bone._x;
+		y[i] = bone._y;
+		angleX[i] = bone._rotation + bone._shearX;
+		angleY[i] = bone._rotation + 90 + bone._shearY;
+		scaleX[i] = bone._scaleX;
+		scaleY[i] = bone._scaleY;
+	}
+
+	// Local 2x2 matrices, 4 bones at a time.
+	for (size_t i = 0; i < count; i += 4) {
+		simd::sinCosDeg(angleX + i, lc + i, la + i);
+		simd::sinCosDeg(angleY + i, ld + i, lb + i);
+		simd::Float4 sx = simd::load(scaleX + i), sy = simd::load(scaleY + i);
+		simd::store(la + i, simd::mul(simd::load(la + i), sx));
+		simd::store(lb + i, simd::mul(simd::load(lb + i), sy));
+		simd::store(lc + i, simd::mul(simd::load(lc + i), sx));
+		simd::store(ld + i, simd::mul(simd::load(ld + i), sy));
+	}
+
+	// Parents come first, so a single pass composes the world transforms.
+	for (size_t i = 0; i < count; ++i) {
+		Bone &bone = *(Bone *) _updateCache[start + i];
+		int parentIndex = _poseParents[start + i];
+		float pa, pb, pc, pd, px, py;
+		if (parentIndex >= 0) {
+			size_t p = parentIndex - start;
+			pa = a[p];
+			pb = b[p];
+			pc = c[p];
+			pd = d[p];
+			px = worldX[p];
+			py = worldY[p];
+		} else {
+			Bone &parent = *bone._parent;
+			pa = parent._a;
+			pb = parent._b;
+			pc = parent._c;
+			pd = parent._d;
+			px = parent._worldX;
+			py = parent._worldY;
+		}
+		worldX[i] = pa * x[i] + pb * y[i] + px;
+		worldY[i] = pc * x[i] + pd * y[i] + py;
+		a[i] = pa * la[i] + pb * lc[i];
+		b[i] = pa * lb[i] + pb * ld[i];
+		c[i] = pc * la[i] + pd * lc[i];
+		d[i] = pc * lb[i] + pd * ld[i];
+
+		bone._a = a[i];
+		bone._b = b[i];
+		bone._c = c[i];
+		bone._d = d[i];
+		bone._worldX = worldX[i];
+		bone._worldY = worldY[i];
+	}
+	// Written directly, unlike Bone::updateWorldTransform().
+	_boneMatricesDirty = true;
 }
 
 void Skeleton::printUpdateCache() {
@@ -213,6 +356,7 @@ void Skeleton::printUpdateCache() {
 }
 
 void Skeleton::updateWorldTransform() {
+	_boneMatricesDirty = true;
 	for (size_t i = 0, n = _updateCacheReset.size(); i < n; ++i) {
 		Bone *boneP = _updateCacheReset[i];
 		Bone &bone = *boneP;
@@ -226,9 +370,34 @@ void Skeleton::updateWorldTransform() {
 		bone._appliedValid = true;
 	}
 
+	if (_batchedPose) {
+		for (size_t i = 0, n = _updateCache.size(); i < n;) {
+			size_t count = _poseRuns[i];
+			if (count > 0) {
+				updatePoseRun(i, count);
+				i += count;
+			} else {
+				_updateCache[i]->update();
+				++i;
+			}
+		}
+		// Repack on the next getBoneMatrices() even if an update wrote a world transform without marking it.
+		_boneMatricesDirty = true;
+		return;
+	}
+
 	for (size_t i = 0, n = _updateCache.size(); i < n; ++i) {
 		_updateCache[i]->update();
 	}
+	_boneMatricesDirty = true;
+}
+
+void Skeleton::setBatchedPose(bool inValue) {
+	_batchedPose = inValue;
+}
+
+bool Skeleton::isBatchedPose() {
+	return _batchedPose;
 }
 
 void Skeleton::setToSetupPose() {
@@ -475,6 +644,28 @@ Vector<Bone *> &Skeleton::getBones() {
 	return _bones;
 }
 
+float *Skeleton::getBoneMatrices() {
+	size_t n = _bones.size();
+	if (_boneMatrices.size() != n * 6) {
+		_boneMatrices.setSize(n * 6, 0);
+		_boneMatricesDirty = true;
+	}
+	if (_boneMatricesDirty) {
+		float *a = _boneMatrices.buffer(), *b = a + n, *c = b + n, *d = c + n, *x = d + n, *y = x + n;
+		for (size_t i = 0; i < n; ++i) {
+			Bone &bone = *_bones[i];
+			a[i] = bone._a;
+			b[i] = bone._b;
+			c[i] = bone._c;
+			d[i] = bone._d;
+			x[i] = bone._worldX;
+			y[i] = bone._worldY;
+		}
+		_boneMatricesDirty = false;
+	}
+	return _boneMatrices.buffer();
+}
+
 Vector<Updatable *> &Skeleton::getUpdateCacheList() {
 	return _updateCache;
 }
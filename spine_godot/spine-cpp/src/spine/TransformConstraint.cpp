@@ -79,6 +79,8 @@ void TransformConstraint::update() {
 			applyRelativeWorld();
 		else
 			applyAbsoluteWorld();
+		// The world transforms were written directly, see Skeleton::getBoneMatrices().
+		_target->getSkeleton()._boneMatricesDirty = true;
 	}
 }
 
@@ -37,6 +37,7 @@
 
 #include <spine/Bone.h>
 #include <spine/Skeleton.h>
+#include <spine/Simd.h>
 
 using namespace spine;
 
@@ -61,6 +62,10 @@ void VertexAttachment::computeWorldVertices(Slot &slot, size_t start, size_t cou
 }
 
 void VertexAttachment::computeWorldVertices(Slot &slot, size_t start, size_t count, float *worldVertices, size_t offset, size_t stride) {
+	computeWorldVerticesSimd(slot, start, count, worldVertices, offset, stride);
+}
+
+void VertexAttachment::computeWorldVerticesScalar(Slot &slot, size_t start, size_t count, float *worldVertices, size_t offset, size_t stride) {
 	count = offset + (count >> 1) * stride;
 	Skeleton &skeleton = slot._bone._skeleton;
 	Vector<float> *deformArray = &slot.getDeform();
@@ -127,6 +132,115 @@ void VertexAttachment::computeWorldVertices(Slot &slot, size_t start, size_t cou
 	}
 }
 
+void VertexAttachment::computeWorldVerticesSimd(Slot &slot, size_t start, size_t count, float *worldVertices, size_t offset, size_t stride) {
+	size_t numVertices = count >> 1;
+	Skeleton &skeleton = slot._bone._skeleton;
+	Vector<float> *deformArray = &slot.getDeform();
+	const float *vertices = _vertices.buffer();
+	float *output = worldVertices + offset;
+	size_t i = 0;
+	if (_bones.size() == 0) {
+		if (deformArray->size() > 0) vertices = deformArray->buffer();
+		vertices += start;
+
+		Bone &bone = slot._bone;
+		simd::Float4 a = simd::splat(bone._a), b = simd::splat(bone._b), c = simd::splat(bone._c), d = simd::splat(bone._d);
+		simd::Float4 x = simd::splat(bone._worldX), y = simd::splat(bone._worldY);
+		for (; i + 4 <= numVertices; i += 4, vertices += 8, output += stride * 4) {
+			simd::Float4 vx, vy;
+			simd::loadPairs(vertices, vx, vy);
+			simd::storePairs(output, simd::transform(vx, vy, a, b, x), simd::transform(vx, vy, c, d, y), stride);
+		}
+		for (; i < numVertices; i++, vertices += 2, output += stride) {
+			float vx = vertices[0], vy = vertices[1];
+			output[0] = vx * bone._a + vy * bone._b + bone._worldX;
+			output[1] = vx * bone._c + vy * bone._d + bone._worldY;
+		}
+		return;
+	}
+
+	const size_t *bones = _bones.buffer();
+	size_t v = 0, skip = 0;
+	for (size_t j = 0; j < start; j += 2) {
+		size_t n = bones[v];
+		v += n + 1;
+		skip += n;
+	}
+
+	// Bone transforms as structure of arrays, indexed by the bone indices in _bones.
+	size_t numBones = skeleton.getBones().size();
+	const float *boneA = skeleton.getBoneMatrices();
+	const float *boneB = boneA + numBones, *boneC = boneB + numBones, *boneD = boneC + numBones;
+	const float *boneX = boneD + numBones, *boneY = boneX + numBones;
+	const float *deform = deformArray->size() > 0 ? deformArray->buffer() : NULL;
+
+	// Each lane walks the influences of one vertex, lanes that ran out of influences add zero.
+	float la[4], lb[4], lc[4], ld[4], lx[4], ly[4], lvx[4], lvy[4], lweight[4];
+	size_t laneV[4], laneB[4], laneN[4];
+	size_t b = skip * 3;
+	for (; i + 4 <= numVertices; i += 4, output += stride * 4) {
+		size_t maxN = 0;
+		for (int k = 0; k < 4; k++) {
+			laneN[k] = bones[v];
+			laneV[k] = v + 1;
+			laneB[k] = b;
+			v += laneN[k] + 1;
+			b += laneN[k] * 3;
+			maxN = MathUtil::max(maxN, laneN[k]);
+		}
+
+		simd::Float4 wx = simd::splat(0), wy = simd::splat(0);
+		for (size_t j = 0; j < maxN; j++) {
+			for (int k = 0; k < 4; k++) {
+				if (j < laneN[k]) {
+					size_t bone = bones[laneV[k] + j];
+					size_t vertex = laneB[k] + j * 3;
+					la[k] = boneA[bone];
+					lb[k] = boneB[bone];
+					lc[k] = boneC[bone];
+					ld[k] = boneD[bone];
+					lx[k] = boneX[bone];
+					ly[k] = boneY[bone];
+					lvx[k] = vertices[vertex];
+					lvy[k] = vertices[vertex + 1];
+					lweight[k] = vertices[vertex + 2];
+					if (deform) {
+						size_t f = vertex / 3 * 2;
+						lvx[k] += deform[f];
+						lvy[k] += deform[f + 1];
+					}
+				} else {
+					la[k] = lb[k] = lc[k] = ld[k] = lx[k] = ly[k] = 0;
+					lvx[k] = lvy[k] = lweight[k] = 0;
+				}
+			}
+			simd::Float4 vx = simd::load(lvx), vy = simd::load(lvy), weight = simd::load(lweight);
+			wx = simd::add(wx, simd::mul(simd::transform(vx, vy, simd::load(la), simd::load(lb), simd::load(lx)), weight));
+			wy = simd::add(wy, simd::mul(simd::transform(vx, vy, simd::load(lc), simd::load(ld), simd::load(ly)), weight));
+		}
+		simd::storePairs(output, wx, wy, stride);
+	}
+
+	for (size_t f = b / 3 * 2; i < numVertices; i++, output += stride) {
+		float wx = 0, wy = 0;
+		size_t n = bones[v++];
+		n += v;
+		for (; v < n; v++, b += 3, f += 2) {
+			size_t bone = bones[v];
+			float vx = vertices[b], vy = vertices[b + 1];
+			if (deform) {
+				vx += deform[f];
+				vy += deform[f + 1];
+			}
+			float weight = vertices[b + 2];
+			wx += (vx * boneA[bone] + vy * boneB[bone] + boneX[bone]) * weight;
+			wy += (vx * boneC[bone] + vy * boneD[bone] + boneY[bone]) * weight;
+		}
+		output[0] = wx;
+		output[1] = wy;
+	}
+}
+
 int VertexAttachment::getId() {
 	return _id;
 }
@@ -0,0 +1,227 @@
+/******************************************************************************
+ * Spine Runtimes License Agreement
+ * Last updated April 5, 2025. Replaces all prior versions.
+ *
+ * Copyright (c) 2013-2025, Esoteric Software LLC
+ *
+ * Integration of the Spine Runtimes into software or otherwise creating
+ * derivative works of the Spine Runtimes is permitted under the terms and
+ * conditions of Section 2 of the Spine Editor License Agreement:
+ * http://esotericsoftware.com/spine-editor-license
+ *
+ * Otherwise, it is permitted to integrate the Spine Runtimes into software
+ * or otherwise create derivative works of the Spine Runtimes (collectively,
+ * "Products"), provided that each user of the Products must obtain their own
+ * Spine Editor license and redistribution of the Products in any form must
+ * include this license and copyright notice.
+ *
+ * THE SPINE RUNTIMES ARE PROVIDED BY ESOTERIC SOFTWARE LLC "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ESOTERIC SOFTWARE LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES,
+ * BUSINESS INTERRUPTION, OR LOSS OF USE, DATA, OR PROFITS) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THE SPINE RUNTIMES, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#pragma once
+
+#include "core/math/random_pcg.h"
+#include "tests/test_macros.h"
+
+#include <float.h>
+#include <spine/Simd.h>
+#include <spine/spine.h>
+
+namespace TestSpineWorldVertices {
+
+static const int NUM_BONES = 7;
+
+// Fills the mesh with p_num_vertices random vertices, weighted vertices get 1 to 4 influences.
+static void fill_mesh(spine::MeshAttachment &p_mesh, int p_num_vertices, bool p_weighted, RandomPCG &p_rng) {
+	spine::Vector<size_t> &bones = p_mesh.getBones();
+	spine::Vector<float> &vertices = p_mesh.getVertices();
+	for (int v = 0; v < p_num_vertices; v++) {
+		if (!p_weighted) {
+			vertices.add(p_rng.random(-50.0f, 50.0f));
+			vertices.add(p_rng.random(-50.0f, 50.0f));
+			continue;
+		}
+		int num_influences = 1 + p_rng.rand() % 4;
+		bones.add(num_influences);
+		for (int k = 0; k < num_influences; k++) {
+			bones.add(p_rng.rand() % NUM_BONES);
+			vertices.add(p_rng.random(-50.0f, 50.0f));
+			vertices.add(p_rng.random(-50.0f, 50.0f));
+			vertices.add(1.0f / num_influences);
+		}
+	}
+	p_mesh.setWorldVerticesLength(p_num_vertices * 2);
+}
+
+// Deform offsets cover every vertex value, or every influence of weighted meshes.
+static void fill_deform(spine::Slot &p_slot, spine::MeshAttachment &p_mesh, bool p_weighted, RandomPCG &p_rng) {
+	spine::Vector<float> &deform = p_slot.getDeform();
+	deform.clear();
+	size_t num_values = p_weighted ? p_mesh.getVertices().size() / 3 * 2 : p_mesh.getWorldVerticesLength();
+	for (size_t i = 0; i < num_values; i++) {
+		deform.add(p_rng.random(-5.0f, 5.0f));
+	}
+}
+
+// Targets with fused multiply-add, where the compiler may contract the scalar reference (GCC and Clang
+// do by default) while the SIMD path keeps separate multiplies and adds. Contraction changes the result
+// by a few ULPs of the largest intermediate value, which stays below 128 in these tests.
+#if defined(SPINE_SIMD_NEON) || defined(__FMA__) || defined(__ARM_FEATURE_FMA)
+#define SPINE_TEST_FMA_ULPS 4
+
+static bool is_fma_equal(float p_actual, float p_expected) {
+	return Math::abs(p_actual - p_expected) <= SPINE_TEST_FMA_ULPS * FLT_EPSILON * MAX(128.0f, Math::abs(p_expected));
+}
+#endif
+
+static void check_world_vertices(spine::Slot &p_slot, spine::MeshAttachment &p_mesh, size_t p_start, size_t p_offset, size_t p_stride) {
+	size_t count = p_mesh.getWorldVerticesLength() - p_start;
+	size_t size = p_offset + count / 2 * p_stride;
+	spine::Vector<float> expected, actual;
+	expected.setSize(size, 0);
+	actual.setSize(size, 0);
+	p_mesh.computeWorldVerticesScalar(p_slot, p_start, count, expected.buffer(), p_offset, p_stride);
+	p_mesh.computeWorldVerticesSimd(p_slot, p_start, count, actual.buffer(), p_offset, p_stride);
+	for (size_t i = 0; i < size; i++) {
+#ifdef SPINE_TEST_FMA_ULPS
+		bool equal = is_fma_equal(actual[i], expected[i]);
+#else
+		// Same operations in the same order, the results must be identical.
+		bool equal = actual[i] == expected[i];
+#endif
+		if (!equal) {
+			FAIL_CHECK(vformat("Value %d differs: %.9f (SIMD) vs %.9f (scalar).", (int)i, actual[i], expected[i]));
+			return;
+		}
+	}
+}
+
+TEST_CASE("[Spine] SIMD world vertices match the scalar reference") {
+	spine::SkeletonData *data = new spine::SkeletonData();
+	for (int i = 0; i < NUM_BONES; i++) {
+		data->getBones().add(new spine::BoneData(i, "bone", i ? data->getBones()[i - 1] : nullptr));
+	}
+	data->getSlots().add(new spine::SlotData(0, "slot", *data->getBones()[0]));
+
+	spine::Skeleton *skeleton = new spine::Skeleton(data);
+	for (int i = 0; i < NUM_BONES; i++) {
+		spine::Bone *bone = skeleton->getBones()[i];
+		bone->setRotation(i * 17.0f);
+		bone->setX(i * 3.0f);
+		bone->setScaleX(1.0f + i * 0.1f);
+		bone->setShearY(i * 2.0f);
+	}
+	skeleton->updateWorldTransform();
+	spine::Slot &slot = *skeleton->getSlots()[0];
+
+	RandomPCG rng(42);
+	for (int weighted = 0; weighted < 2; weighted++) {
+		for (int deformed = 0; deformed < 2; deformed++) {
+			// Counts around the 4 vertex SIMD width, including the remainder paths.
+			for (int num_vertices = 1; num_vertices <= 11; num_vertices++) {
+				spine::MeshAttachment mesh("mesh");
+				fill_mesh(mesh, num_vertices, weighted, rng);
+				slot.getDeform().clear();
+				if (deformed) fill_deform(slot, mesh, weighted, rng);
+
+				INFO(vformat("weighted %d, deformed %d, %d vertices", weighted, deformed, num_vertices));
+				check_world_vertices(slot, mesh, 0, 0, 2);
+				// Interleaved output as used for batched vertex buffers.
+				check_world_vertices(slot, mesh, 0, 3, 4);
+				if (num_vertices > 2) check_world_vertices(slot, mesh, 4, 1, 2);
+			}
+		}
+	}
+
+	slot.getDeform().clear();
+	delete skeleton;
+	delete data;
+}
+
+TEST_CASE("[Spine] SIMD world vertices see bones moved by a path constraint") {
+	// Bones: root, the path bone, the bone the path constraint moves and its child.
+	spine::SkeletonData *data = new spine::SkeletonData();
+	spine::BoneData *root_data = new spine::BoneData(0, "root");
+	spine::BoneData *path_bone_data = new spine::BoneData(1, "path", root_data);
+	spine::BoneData *constrained_data = new spine::BoneData(2, "constrained", root_data);
+	data->getBones().add(root_data);
+	data->getBones().add(path_bone_data);
+	data->getBones().add(constrained_data);
+	data->getBones().add(new spine::BoneData(3, "child", constrained_data));
+	spine::SlotData *path_slot_data = new spine::SlotData(0, "path", *path_bone_data);
+	spine::SlotData *mesh_slot_data = new spine::SlotData(1, "mesh", *constrained_data);
+	data->getSlots().add(path_slot_data);
+	data->getSlots().add(mesh_slot_data);
+
+	spine::PathConstraintData *constraint_data = new spine::PathConstraintData("constraint");
+	constraint_data->getBones().add(constrained_data);
+	constraint_data->setTarget(path_slot_data);
+	constraint_data->setPositionMode(spine::PositionMode_Fixed);
+	constraint_data->setSpacingMode(spine::SpacingMode_Length);
+	constraint_data->setRotateMode(spine::RotateMode_Tangent);
+	constraint_data->setPosition(25);
+	constraint_data->setTranslateMix(1);
+	constraint_data->setRotateMix(1);
+	data->getPathConstraints().add(constraint_data);
+
+	// A weighted path makes the constraint read the bone matrices before it moves its bone.
+	spine::PathAttachment path("path");
+	for (int i = 0; i < 6; i++) {
+		path.getBones().add(1);
+		path.getBones().add(1);
+		path.getVertices().add(i * 10.0f);
+		path.getVertices().add(i % 2 ? 5.0f : -5.0f);
+		path.getVertices().add(1);
+	}
+	path.setWorldVerticesLength(12);
+	path.getLengths().add(50);
+
+	// The child is posed after the constraint, in a pose run when batched_pose is on.
+	spine::MeshAttachment mesh("mesh");
+	for (int i = 0; i < 4; i++) {
+		mesh.getBones().add(2);
+		mesh.getBones().add(2);
+		mesh.getVertices().add(i & 1 ? 8.0f : -8.0f);
+		mesh.getVertices().add(i & 2 ? 4.0f : -4.0f);
+		mesh.getVertices().add(0.5f);
+		mesh.getBones().add(3);
+		mesh.getVertices().add(i & 1 ? 6.0f : -6.0f);
+		mesh.getVertices().add(i & 2 ? 2.0f : -2.0f);
+		mesh.getVertices().add(0.5f);
+	}
+	mesh.setWorldVerticesLength(8);
+
+	spine::Skeleton *skeleton = new spine::Skeleton(data);
+	skeleton->getSlots()[0]->setAttachment(&path);
+	skeleton->getSlots()[1]->setAttachment(&mesh);
+	skeleton->updateCache();
+	skeleton->getBones()[1]->setRotation(30);
+	skeleton->getBones()[1]->setX(20);
+	skeleton->getBones()[2]->setY(-40);
+	skeleton->getBones()[3]->setX(12);
+	for (int batched = 0; batched < 2; batched++) {
+		skeleton->setBatchedPose(batched);
+		skeleton->updateWorldTransform();
+
+		INFO(vformat("batched pose %d", batched));
+		spine::Bone *constrained = skeleton->getBones()[2];
+		CHECK_MESSAGE(constrained->getWorldY() != doctest::Approx(-40), "The path constraint must move the bone.");
+		check_world_vertices(*skeleton->getSlots()[1], mesh, 0, 0, 2);
+	}
+
+	skeleton->getSlots()[0]->setAttachment(nullptr);
+	skeleton->getSlots()[1]->setAttachment(nullptr);
+	delete skeleton;
+	delete data;
+}
+
+} // namespace TestSpineWorldVertices